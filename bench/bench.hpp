@@ -0,0 +1,123 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// A small benchmark harness shared by the bench targets.
+///
+/// Every case is repeated `--repetitions N` times (default 5) and each repetition contributes one sample,
+/// so that downstream tooling can compare distributions rather than single numbers.
+/// Results are printed as a table; `--json <file>` also writes them in the format read by `bench_compare`.
+/// `--filter <text>` runs only the cases whose name contains `text`.
+class bench_runner {
+public:
+    struct metric {
+        std::string name;
+        std::string unit;
+        bool higher_is_better;
+        std::vector<double> samples;
+    };
+
+    bench_runner(int argc, char** argv, int default_repetitions = 5) : repetitions_(default_repetitions) {
+        for (int i = 1; i < argc; ++i) {
+            auto arg = std::string_view(argv[i]);
+            if (arg == "--json" && i + 1 < argc) {
+                json_path_ = argv[++i];
+            } else if (arg == "--repetitions" && i + 1 < argc) {
+                repetitions_ = std::max(1, std::atoi(argv[++i]));
+            } else if (arg == "--filter" && i + 1 < argc) {
+                filter_ = argv[++i];
+            }
+        }
+    }
+
+    ~bench_runner() {
+        report();
+    }
+
+    bench_runner(const bench_runner&) = delete;
+    bench_runner& operator=(const bench_runner&) = delete;
+
+    int repetitions() const noexcept {
+        return repetitions_;
+    }
+
+    bool enabled(std::string_view name) const {
+        return filter_.empty() || name.find(filter_) != std::string_view::npos;
+    }
+
+    /// Time `body(iterations)` once per repetition and record nanoseconds per iteration.
+    template <typename Body>
+    void run(const std::string& name, std::size_t iterations, Body&& body) {
+        if (!enabled(name)) return;
+
+        body(std::max<std::size_t>(1, iterations / 10)); // warm-up
+        for (int r = 0; r < repetitions_; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            body(iterations);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            record(name, "ns/op", false,
+                std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations));
+        }
+    }
+
+    /// Add one sample to a (possibly new) metric.
+    void record(const std::string& name, const std::string& unit, bool higher_is_better, double value) {
+        auto it = std::find_if(metrics_.begin(), metrics_.end(), [&](auto& m) { return m.name == name; });
+        if (it == metrics_.end()) {
+            it = metrics_.insert(metrics_.end(), metric { name, unit, higher_is_better, {} });
+        }
+        it->samples.push_back(value);
+    }
+
+    const std::vector<metric>& metrics() const noexcept {
+        return metrics_;
+    }
+
+    static double median(std::vector<double> samples) {
+        std::sort(samples.begin(), samples.end());
+        auto n = samples.size();
+        return n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    }
+
+private:
+    void report() const {
+        std::cout << std::left << std::setw(48) << "benchmark"
+                  << std::right << std::setw(14) << "median" << std::setw(14) << "min" << std::setw(14) << "max"
+                  << "  unit" << std::endl;
+        for (auto& m : metrics_) {
+            auto [lo, hi] = std::minmax_element(m.samples.begin(), m.samples.end());
+            std::cout << std::left << std::setw(48) << m.name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(14) << median(m.samples) << std::setw(14) << *lo << std::setw(14) << *hi
+                      << "  " << m.unit << std::endl;
+        }
+
+        if (json_path_.empty()) return;
+
+        auto out = std::ofstream(json_path_);
+        out << "{\n  \"benchmarks\": [";
+        for (std::size_t i = 0; i < metrics_.size(); ++i) {
+            auto& m = metrics_[i];
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << m.name << "\", \"unit\": \"" << m.unit
+                << "\", \"higher_is_better\": " << (m.higher_is_better ? "true" : "false") << ", \"samples\": [";
+            for (std::size_t s = 0; s < m.samples.size(); ++s) {
+                out << (s ? ", " : "") << std::setprecision(17) << m.samples[s];
+            }
+            out << "]}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    std::vector<metric> metrics_;
+    std::string json_path_;
+    std::string filter_;
+    int repetitions_;
+};
@@ -0,0 +1,362 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench.hpp"
+
+// Regression gate: compares two `--json` outputs of the bench targets (or `load_test`).
+//
+//     bench_compare baseline.json candidate.json [--threshold 5] [--alpha 0.05] [--filter text]
+//
+// For every metric in both files it prints the median of each side, the change of the median and
+// the two-sided Mann-Whitney U p-value of the samples. A metric regresses when it got worse (by
+// its `higher_is_better` direction) by more than `--threshold` percent and the change is
+// significant (p < `--alpha`); then the exit code is 1. Needs a few repetitions per side: with 5 and
+// 5 the smallest possible p is 0.008, with 3 and 3 it is 0.1. A metric whose sample counts cannot
+// reach p < `--alpha` at all is an error rather than a silent pass.
+//
+// Exit codes: 0 no regression, 1 regression, 2 bad usage or input, or too few samples.
+
+/// Reads the `{"benchmarks": [{"name", "unit", "higher_is_better", "samples"}, ...]}` files written
+/// by `bench_runner`. Not a general JSON parser: objects and arrays of strings, numbers and booleans.
+class bench_json_reader {
+public:
+    explicit bench_json_reader(std::string text) : text_(std::move(text)) {}
+
+    std::vector<bench_runner::metric> read() {
+        auto metrics = std::vector<bench_runner::metric>();
+        expect('{');
+        if (!consume('}')) {
+            do {
+                auto key = string();
+                expect(':');
+                if (key == "benchmarks") {
+                    expect('[');
+                    if (!consume(']')) {
+                        do {
+                            metrics.push_back(metric());
+                        } while (consume(','));
+                        expect(']');
+                    }
+                } else {
+                    skip();
+                }
+            } while (consume(','));
+            expect('}');
+        }
+        return metrics;
+    }
+
+private:
+    bench_runner::metric metric() {
+        auto m = bench_runner::metric {};
+        expect('{');
+        if (!consume('}')) {
+            do {
+                auto key = string();
+                expect(':');
+                if (key == "name") {
+                    m.name = string();
+                } else if (key == "unit") {
+                    m.unit = string();
+                } else if (key == "higher_is_better") {
+                    m.higher_is_better = boolean();
+                } else if (key == "samples") {
+                    expect('[');
+                    if (!consume(']')) {
+                        do {
+                            m.samples.push_back(number());
+                        } while (consume(','));
+                        expect(']');
+                    }
+                } else {
+                    skip();
+                }
+            } while (consume(','));
+            expect('}');
+        }
+        return m;
+    }
+
+    // skips any value
+    void skip() {
+        auto c = peek();
+        if (c == '"') {
+            string();
+        } else if (c == '{' || c == '[') {
+            auto close = c == '{' ? '}' : ']';
+            ++pos_;
+            if (consume(close)) return;
+            do {
+                if (c == '{') {
+                    string();
+                    expect(':');
+                }
+                skip();
+            } while (consume(','));
+            expect(close);
+        } else if (c == 't' || c == 'f') {
+            boolean();
+        } else if (text_.compare(pos_, 4, "null") == 0) {
+            pos_ += 4;
+        } else {
+            number();
+        }
+    }
+
+    std::string string() {
+        expect('"');
+        auto out = std::string();
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            // bench names need no escapes beyond a backslash before the next character
+            if (text_[pos_] == '\\' && pos_ + 1 < text_.size()) ++pos_;
+            out += text_[pos_++];
+        }
+        expect('"');
+        return out;
+    }
+
+    double number() {
+        peek();
+        auto begin = text_.c_str() + pos_;
+        char* end = nullptr;
+        auto value = std::strtod(begin, &end);
+        if (end == begin) fail("number");
+        pos_ += static_cast<std::size_t>(end - begin);
+        return value;
+    }
+
+    bool boolean() {
+        peek();
+        if (text_.compare(pos_, 4, "true") == 0) {
+            pos_ += 4;
+            return true;
+        }
+        if (text_.compare(pos_, 5, "false") == 0) {
+            pos_ += 5;
+            return false;
+        }
+        fail("true or false");
+    }
+
+    char peek() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    bool consume(char c) {
+        if (peek() != c) return false;
+        ++pos_;
+        return true;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) fail(std::string("'") + c + "'");
+    }
+
+    [[noreturn]] void fail(const std::string& expected) {
+        throw std::runtime_error("expected " + expected + " at offset " + std::to_string(pos_));
+    }
+
+    std::string text_;
+    std::size_t pos_ {};
+};
+
+std::vector<bench_runner::metric> read_bench_json(const std::string& path) {
+    auto in = std::ifstream(path);
+    if (!in) throw std::runtime_error("cannot open " + path);
+    auto text = std::ostringstream();
+    text << in.rdbuf();
+    try {
+        return bench_json_reader(text.str()).read();
+    } catch (const std::exception& e) {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+}
+
+/// Two-sided p-value of the Mann-Whitney U test that `a` and `b` come from the same distribution.
+/// Exact for small samples without ties, otherwise the normal approximation with tie correction.
+double mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b) {
+    auto n1 = a.size();
+    auto n2 = b.size();
+    if (n1 == 0 || n2 == 0) return 1;
+
+    // U of `a`: pairs where a's sample is larger, ties counting half
+    auto u = 0.0;
+    auto ties = false;
+    for (auto x : a) {
+        for (auto y : b) {
+            if (x > y) u += 1;
+            else if (x == y) {
+                u += 0.5;
+                ties = true;
+            }
+        }
+    }
+
+    if (!ties && n1 + n2 <= 40) {
+        // counts[k]: orderings of n1 + n2 samples in which U is k, built up one sample at a time
+        auto max_u = n1 * n2;
+        auto table = std::vector<std::vector<double>>(n2 + 1, std::vector<double>(max_u + 1));
+        for (std::size_t j = 0; j <= n2; ++j) table[j][0] = 1; // 0 samples of `a`
+        for (std::size_t i = 1; i <= n1; ++i) {
+            auto next = std::vector<std::vector<double>>(n2 + 1, std::vector<double>(max_u + 1));
+            next[0][0] = 1;
+            for (std::size_t j = 1; j <= n2; ++j) {
+                for (std::size_t k = 0; k <= max_u; ++k) {
+                    // the largest sample is a's (beating all j of b's) or b's
+                    next[j][k] = (k >= j ? table[j][k - j] : 0) + next[j - 1][k];
+                }
+            }
+            table = std::move(next);
+        }
+        auto& counts = table[n2];
+        auto total = 0.0, at_most = 0.0, at_least = 0.0;
+        for (std::size_t k = 0; k <= max_u; ++k) {
+            total += counts[k];
+            if (static_cast<double>(k) <= u) at_most += counts[k];
+            if (static_cast<double>(k) >= u) at_least += counts[k];
+        }
+        return std::min(1.0, 2 * std::min(at_most, at_least) / total);
+    }
+
+    // normal approximation; ties shrink the variance
+    auto all = a;
+    all.insert(all.end(), b.begin(), b.end());
+    std::sort(all.begin(), all.end());
+    auto tie_term = 0.0;
+    for (std::size_t i = 0; i < all.size();) {
+        auto j = i;
+        while (j < all.size() && all[j] == all[i]) ++j;
+        auto t = static_cast<double>(j - i);
+        tie_term += t * t * t - t;
+        i = j;
+    }
+    auto n = static_cast<double>(n1 + n2);
+    auto mean = static_cast<double>(n1 * n2) / 2;
+    auto variance = static_cast<double>(n1 * n2) / 12 * ((n + 1) - tie_term / (n * (n - 1)));
+    if (variance <= 0) return 1;
+    auto z = (std::abs(u - mean) - 0.5) / std::sqrt(variance);
+    return std::min(1.0, std::erfc(std::max(z, 0.0) / std::sqrt(2.0)));
+}
+
+/// The smallest two-sided p-value `mann_whitney_p` can return for these sample counts: that of
+/// fully separated samples, 2 / C(n1 + n2, n1).
+double mann_whitney_min_p(std::size_t n1, std::size_t n2) {
+    auto orderings = 1.0;
+    for (std::size_t k = 1; k <= std::min(n1, n2); ++k) {
+        orderings = orderings * static_cast<double>(n1 + n2 - std::min(n1, n2) + k) / static_cast<double>(k);
+    }
+    return std::min(1.0, 2 / orderings);
+}
+
+struct compare_options {
+    std::string baseline;
+    std::string candidate;
+    double threshold = 5;       // percent
+    double alpha = 0.05;
+    std::string filter;
+};
+
+int compare(const compare_options& opts) {
+    auto baseline = read_bench_json(opts.baseline);
+    auto candidate = read_bench_json(opts.candidate);
+
+    std::cout << std::left << std::setw(48) << "benchmark" << std::right << std::setw(14) << "baseline"
+              << std::setw(14) << "candidate" << std::setw(10) << "change" << std::setw(8) << "p"
+              << "  unit" << std::endl;
+
+    auto regressions = 0;
+    auto untestable = 0;
+    for (auto& base : baseline) {
+        if (!opts.filter.empty() && base.name.find(opts.filter) == std::string::npos) continue;
+        auto it = std::find_if(candidate.begin(), candidate.end(), [&](auto& m) { return m.name == base.name; });
+        if (it == candidate.end()) {
+            std::cout << std::left << std::setw(48) << base.name << "  missing in candidate" << std::endl;
+            continue;
+        }
+        if (base.samples.empty() || it->samples.empty()) continue;
+
+        auto before = bench_runner::median(base.samples);
+        auto after = bench_runner::median(it->samples);
+        auto change = before != 0 ? (after - before) / std::abs(before) * 100 : 0.0;
+        auto worse = base.higher_is_better ? -change : change;
+        auto p = mann_whitney_p(base.samples, it->samples);
+        auto significant = p < opts.alpha;
+
+        auto verdict = "";
+        if (mann_whitney_min_p(base.samples.size(), it->samples.size()) >= opts.alpha) {
+            verdict = "  TOO FEW SAMPLES";
+            ++untestable;
+        } else if (significant && worse > opts.threshold) {
+            verdict = "  REGRESSION";
+            ++regressions;
+        } else if (significant && -worse > opts.threshold) {
+            verdict = "  improved";
+        }
+
+        std::cout << std::left << std::setw(48) << base.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << before << std::setw(14) << after << std::showpos << std::setw(9) << change
+                  << "%" << std::noshowpos << std::setprecision(3) << std::setw(8) << p << "  " << base.unit
+                  << verdict << std::endl;
+    }
+    for (auto& cand : candidate) {
+        if (!opts.filter.empty() && cand.name.find(opts.filter) == std::string::npos) continue;
+        if (std::none_of(baseline.begin(), baseline.end(), [&](auto& m) { return m.name == cand.name; })) {
+            std::cout << std::left << std::setw(48) << cand.name << "  new in candidate" << std::endl;
+        }
+    }
+
+    if (untestable) {
+        std::cerr << "bench_compare: " << untestable << " metric(s) have too few samples to reach p < " << opts.alpha
+                  << "; rerun the benchmarks with more --repetitions" << std::endl;
+        return 2;
+    }
+    if (regressions) {
+        std::cout << std::defaultfloat << regressions << " regression(s) over " << opts.threshold << "% at p < " << opts.alpha << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    auto opts = compare_options();
+    auto files = std::vector<std::string>();
+    for (int i = 1; i < argc; ++i) {
+        auto arg = std::string_view(argv[i]);
+        if (arg == "--threshold" && i + 1 < argc) {
+            opts.threshold = std::atof(argv[++i]);
+        } else if (arg == "--alpha" && i + 1 < argc) {
+            opts.alpha = std::atof(argv[++i]);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            opts.filter = argv[++i];
+        } else {
+            files.emplace_back(arg);
+        }
+    }
+    if (files.size() != 2) {
+        std::cerr << "usage: bench_compare baseline.json candidate.json [--threshold percent] [--alpha p] [--filter text]"
+                  << std::endl;
+        return 2;
+    }
+    opts.baseline = files[0];
+    opts.candidate = files[1];
+
+    try {
+        return compare(opts);
+    } catch (const std::exception& e) {
+        std::cerr << "bench_compare: " << e.what() << std::endl;
+        return 2;
+    }
+}
@@ -0,0 +1,121 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string_view>
+
+#include "bench.hpp"
+#include "frame_codec.hpp"
+
+// Compression ratio and encode/decode throughput of the frame codecs.
+// Synthetic frames cover the easy and hard cases; `--frames <file>` adds recorded frames
+// (a raw dump of int32 values, split into frames of `--frame-size` values).
+
+struct frame_set {
+    std::string name;
+    std::vector<std::vector<int32_t>> frames;
+
+    std::size_t bytes() const {
+        std::size_t total = 0;
+        for (auto& frame : frames) total += frame.size() * sizeof(int32_t);
+        return total;
+    }
+};
+
+frame_set synthetic(const std::string& name, std::size_t count, std::size_t size, auto generate) {
+    auto set = frame_set { name, {} };
+    auto rng = std::mt19937(42);
+    for (std::size_t f = 0; f < count; ++f) {
+        auto& frame = set.frames.emplace_back(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            frame[i] = generate(f, i, rng);
+        }
+    }
+    return set;
+}
+
+frame_set recorded(const std::string& path, std::size_t frame_size) {
+    auto set = frame_set { "recorded", {} };
+    auto in = std::ifstream(path, std::ios::binary);
+    auto frame = std::vector<int32_t>(frame_size);
+    while (in.read(reinterpret_cast<char*>(frame.data()), static_cast<std::streamsize>(frame_size * sizeof(int32_t)))) {
+        set.frames.push_back(frame);
+    }
+    return set;
+}
+
+void run_codec(bench_runner& bench, const frame_codec& codec, const frame_set& set) {
+    auto name = "codec/" + std::string(codec.name()) + "/" + set.name;
+    if (!bench.enabled(name) || set.frames.empty()) return;
+
+    auto encoded = std::vector<std::vector<std::byte>>();
+    std::size_t encoded_bytes = 0;
+    for (auto& frame : set.frames) {
+        auto& out = encoded.emplace_back(codec.max_encoded_size(frame.size()));
+        out.resize(codec.encode(frame, out));
+        encoded_bytes += out.size();
+    }
+    bench.record(name + "/ratio", "raw/encoded", true, double(set.bytes()) / double(encoded_bytes));
+
+    auto scratch = std::vector<std::byte>(codec.max_encoded_size(set.frames.front().size()));
+    auto decoded = std::vector<int32_t>(set.frames.front().size());
+
+    for (int r = 0; r < bench.repetitions(); ++r) {
+        auto start = std::chrono::steady_clock::now();
+        for (auto& frame : set.frames) {
+            scratch.resize(codec.max_encoded_size(frame.size()));
+            codec.encode(frame, scratch);
+        }
+        auto encode_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        bench.record(name + "/encode", "GB/s", true, double(set.bytes()) / encode_s / 1e9);
+
+        start = std::chrono::steady_clock::now();
+        for (std::size_t f = 0; f < set.frames.size(); ++f) {
+            decoded.resize(set.frames[f].size());
+            codec.decode(encoded[f], decoded);
+        }
+        auto decode_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        bench.record(name + "/decode", "GB/s", true, double(set.bytes()) / decode_s / 1e9);
+    }
+}
+
+int main(int argc, char** argv) {
+    auto bench = bench_runner(argc, argv);
+
+    auto recorded_path = std::string();
+    std::size_t frame_size = 1920 * 1080;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string_view(argv[i]) == "--frames") recorded_path = argv[i + 1];
+        if (std::string_view(argv[i]) == "--frame-size") frame_size = std::stoul(argv[i + 1]);
+    }
+
+    const std::size_t count = 16;
+    const std::size_t size = 1920 * 1080 / 4;
+
+    auto sets = std::vector<frame_set> {
+        // an image-like gradient with sensor noise
+        synthetic("gradient_noise", count, size, [](auto f, auto i, auto& rng) {
+            return int32_t((i % 1920) / 8 + f + rng() % 7);
+        }),
+        synthetic("constant", count, size, [](auto, auto, auto&) { return int32_t(128); }),
+        synthetic("counter", count, size, [](auto f, auto i, auto&) { return int32_t(f * size + i); }),
+        synthetic("random_12bit", count, size, [](auto, auto, auto& rng) { return int32_t(rng() & 0xfff); }),
+        synthetic("random_32bit", count, size, [](auto, auto, auto& rng) { return int32_t(rng()); }),
+    };
+    if (!recorded_path.empty()) {
+        sets.push_back(recorded(recorded_path, frame_size));
+    }
+
+    auto codecs = std::vector<std::unique_ptr<frame_codec>>();
+    codecs.push_back(std::make_unique<raw_codec>());
+    codecs.push_back(std::make_unique<delta_zigzag_codec>());
+
+    for (auto& codec : codecs) {
+        for (auto& set : sets) {
+            run_codec(bench, *codec, set);
+        }
+    }
+
+    return 0;
+}
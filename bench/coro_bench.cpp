@@ -0,0 +1,110 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <exec/repeat_effect_until.hpp>
+#include <exec/task.hpp>
+
+#include "bench.hpp"
+#include "decoder.hpp"
+#include "pooled_task.hpp"
+
+// Decode-and-accumulate loop written three ways. The decoder's simulated latency is
+// disabled so that the per-iteration overhead of each front-end dominates.
+
+int32_t run_sender_chain(hw_decoder& decoder, std::size_t iterations) {
+    int32_t total = 0;
+    auto count = iterations;
+
+    stdexec::sync_wait(
+        stdexec::just()
+        | stdexec::let_value([&] {
+            return async_decode_frame<hw_frame>(&decoder)
+                | stdexec::then([&](hw_frame&& frame) {
+                    total += frame.index;
+                    return --count == 0;
+                })
+                | exec::repeat_effect_until();
+        }));
+
+    return total;
+}
+
+exec::task<int32_t> decode_one_task(hw_decoder* decoder) {
+    auto frame = co_await async_decode_frame<hw_frame>(decoder);
+    co_return frame.index;
+}
+
+exec::task<int32_t> decode_loop_task(hw_decoder* decoder, std::size_t iterations) {
+    int32_t total = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        total += co_await decode_one_task(decoder);
+    }
+    co_return total;
+}
+
+pooled_task<int32_t> decode_one_pooled(hw_decoder* decoder) {
+    auto frame = co_await async_decode_frame<hw_frame>(decoder);
+    co_return frame.index;
+}
+
+pooled_task<int32_t> decode_loop_pooled(hw_decoder* decoder, std::size_t iterations) {
+    int32_t total = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        total += co_await decode_one_pooled(decoder);
+    }
+    co_return total;
+}
+
+int main(int argc, char** argv) {
+    auto bench = bench_runner(argc, argv);
+
+    auto decoder = hw_decoder();
+    decoder.latency = {};
+
+    const std::size_t iterations = 20000;
+
+    bench.run("decode_loop/sender_chain", iterations, [&](std::size_t n) {
+        run_sender_chain(decoder, n);
+    });
+
+    bench.run("decode_loop/exec_task", iterations, [&](std::size_t n) {
+        stdexec::sync_wait(decode_loop_task(&decoder, n));
+    });
+
+    bench.run("decode_loop/pooled_task", iterations, [&](std::size_t n) {
+        stdexec::sync_wait(decode_loop_pooled(&decoder, n));
+    });
+
+    // op-state sized blocks: the per-thread slab against the global heap
+    bench.run("alloc/slab_pool", 1000000, [](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            auto p = slab_pool::allocate(192);
+            asm volatile("" : : "r"(p) : "memory");
+            slab_pool::deallocate(p, 192);
+        }
+    });
+
+    bench.run("alloc/operator_new", 1000000, [](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            auto p = ::operator new(192);
+            asm volatile("" : : "r"(p) : "memory");
+            ::operator delete(p, 192);
+        }
+    });
+
+    // allocated here, released on another thread, as for a decode started by the reader and
+    // completed on the decoder's thread
+    bench.run("alloc/slab_pool_remote_free", 100000, [](std::size_t n) {
+        auto blocks = std::vector<void*>(n);
+        for (auto& p : blocks) p = slab_pool::allocate(192);
+        std::thread([&] {
+            for (auto p : blocks) slab_pool::deallocate(p, 192);
+        }).join();
+    });
+
+    std::cout << "slab_pool chunks: " << slab_pool::chunk_count() << std::endl;
+
+    return 0;
+}
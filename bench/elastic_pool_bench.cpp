@@ -0,0 +1,70 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <atomic>
+#include <exec/async_scope.hpp>
+
+#include "bench.hpp"
+#include "elastic_thread_pool.hpp"
+
+using namespace std::chrono_literals;
+
+// Reaction of elastic_thread_pool to a load step: a burst of blocking operations arrives at an idle pool,
+// then the load drops back to zero.
+
+template <typename Predicate>
+double wait_until_ms(Predicate predicate) {
+    auto start = std::chrono::steady_clock::now();
+    while (!predicate()) {
+        std::this_thread::sleep_for(50us);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void load_step(bench_runner& bench, std::size_t max_threads, std::chrono::microseconds grow_latency) {
+    auto name = "elastic_pool/step_to_" + std::to_string(max_threads) + "/grow_latency_"
+        + std::to_string(grow_latency.count()) + "us";
+    if (!bench.enabled(name)) return;
+
+    for (int r = 0; r < bench.repetitions(); ++r) {
+        auto pool = elastic_thread_pool(elastic_thread_pool::options {
+            .min_threads = 1,
+            .max_threads = max_threads,
+            .grow_latency = grow_latency,
+            .idle_timeout = 50ms,
+        });
+        auto sched = pool.get_scheduler();
+        auto scope = exec::async_scope();
+
+        // warm up the floor worker
+        stdexec::sync_wait(sched.schedule());
+
+        std::atomic<std::size_t> completed { 0 };
+        const std::size_t burst = max_threads * 8;
+        for (std::size_t i = 0; i < burst; ++i) {
+            scope.spawn(sched.schedule() | stdexec::then([&] {
+                std::this_thread::sleep_for(5ms);
+                completed.fetch_add(1, std::memory_order_relaxed);
+            }));
+        }
+
+        bench.record(name + "/time_to_max_threads", "ms", false,
+            wait_until_ms([&] { return pool.thread_count() >= max_threads; }));
+
+        stdexec::sync_wait(scope.on_empty());
+
+        bench.record(name + "/time_to_min_threads", "ms", false,
+            wait_until_ms([&] { return pool.thread_count() <= 1; }));
+    }
+}
+
+int main(int argc, char** argv) {
+    auto bench = bench_runner(argc, argv);
+
+    for (std::size_t max_threads : { 4, 16 }) {
+        for (auto grow_latency : { 200us, 1000us }) {
+            load_step(bench, max_threads, grow_latency);
+        }
+    }
+
+    return 0;
+}
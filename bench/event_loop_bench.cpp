@@ -0,0 +1,157 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "event_loop.hpp"
+
+// Hops per second from other threads onto one consumer thread, the `continues_on(main_sched)` of
+// ex01: `event_loop` against `stdexec::run_loop`.
+//
+// burst:     `producers` threads each start their hops as fast as they can while the loop drains.
+// ping_pong: one producer starts a hop only after the previous one ran, so the loop goes idle (and
+//            parks) between hops and every hop pays for a wake-up.
+// teardown:  a loop on the heap is run and destroyed as soon as `run()` returns, while the threads
+//            that scheduled its last hops may still be inside `start()`; a loop that returns too
+//            early shows up as a use-after-free under ASan or a race under TSan.
+//
+// The operation states are connected before the clock starts; only starting and running them is timed.
+
+template <class Loop>
+struct hop_receiver {
+    using receiver_concept = stdexec::receiver_t;
+
+    void set_value() noexcept {
+        if (ran->fetch_add(1, std::memory_order_release) + 1 == total) loop->finish();
+    }
+
+    void set_stopped() noexcept {
+    }
+
+    Loop* loop;
+    std::atomic<std::size_t>* ran;
+    std::size_t total;
+};
+
+template <class Loop>
+struct hop {
+    using sender_t = decltype(stdexec::schedule(std::declval<Loop&>().get_scheduler()));
+    using receiver_t = hop_receiver<Loop>;
+
+    hop(Loop& loop, receiver_t receiver) : op(stdexec::connect(stdexec::schedule(loop.get_scheduler()), receiver)) {}
+
+    stdexec::connect_result_t<sender_t, receiver_t> op;
+};
+
+template <class Loop>
+void burst(bench_runner& bench, const std::string& loop_name, std::size_t producers, std::size_t hops_per_producer) {
+    auto name = loop_name + "/burst/producers" + std::to_string(producers);
+    if (!bench.enabled(name)) return;
+
+    for (int r = 0; r < bench.repetitions(); ++r) {
+        auto loop = Loop();
+        auto ran = std::atomic<std::size_t> { 0 };
+        auto total = producers * hops_per_producer;
+
+        // deque: operation states do not move
+        auto ops = std::vector<std::deque<hop<Loop>>>(producers);
+        for (auto& list : ops) {
+            for (std::size_t i = 0; i < hops_per_producer; ++i) list.emplace_back(loop, hop_receiver<Loop> { &loop, &ran, total });
+        }
+
+        auto go = std::atomic<bool> { false };
+        auto threads = std::vector<std::thread>();
+        for (auto& list : ops) {
+            threads.emplace_back([&go, &list] {
+                while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                for (auto& h : list) stdexec::start(h.op);
+            });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        loop.run();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (auto& thread : threads) thread.join();
+
+        bench.record(name, "hops/s", true, static_cast<double>(total) / elapsed);
+    }
+}
+
+template <class Loop>
+void ping_pong(bench_runner& bench, const std::string& loop_name, std::size_t hops) {
+    auto name = loop_name + "/ping_pong";
+    if (!bench.enabled(name)) return;
+
+    for (int r = 0; r < bench.repetitions(); ++r) {
+        auto loop = Loop();
+        auto ran = std::atomic<std::size_t> { 0 };
+
+        auto ops = std::deque<hop<Loop>>();
+        for (std::size_t i = 0; i < hops; ++i) ops.emplace_back(loop, hop_receiver<Loop> { &loop, &ran, hops });
+
+        auto start = std::chrono::steady_clock::now();
+        auto producer = std::thread([&] {
+            for (std::size_t i = 0; i < hops; ++i) {
+                stdexec::start(ops[i].op);
+                while (ran.load(std::memory_order_acquire) <= i) std::this_thread::yield();
+            }
+        });
+        loop.run();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        producer.join();
+
+        bench.record(name, "hops/s", true, static_cast<double>(hops) / elapsed);
+    }
+}
+
+template <class Loop>
+void teardown(bench_runner& bench, const std::string& loop_name, std::size_t producers, std::size_t loops) {
+    auto name = loop_name + "/teardown/producers" + std::to_string(producers);
+    if (!bench.enabled(name)) return;
+
+    for (int r = 0; r < bench.repetitions(); ++r) {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < loops; ++i) {
+            auto loop = std::make_unique<Loop>();
+            auto ran = std::atomic<std::size_t> { 0 };
+
+            auto ops = std::deque<hop<Loop>>();
+            for (std::size_t p = 0; p < producers; ++p) ops.emplace_back(*loop, hop_receiver<Loop> { loop.get(), &ran, producers });
+
+            auto threads = std::vector<std::thread>();
+            for (auto& h : ops) {
+                threads.emplace_back([&h] { stdexec::start(h.op); });
+            }
+            loop->run();
+            loop.reset();
+            for (auto& thread : threads) thread.join();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        bench.record(name, "ns/loop", false, std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(loops));
+    }
+}
+
+int main(int argc, char** argv) {
+    auto bench = bench_runner(argc, argv);
+
+    const std::size_t hops = 1'000'000;
+
+    for (std::size_t producers : { 1, 2, 4 }) {
+        burst<stdexec::run_loop>(bench, "run_loop", producers, hops / producers);
+        burst<event_loop>(bench, "event_loop", producers, hops / producers);
+    }
+
+    ping_pong<stdexec::run_loop>(bench, "run_loop", hops / 10);
+    ping_pong<event_loop>(bench, "event_loop", hops / 10);
+
+    teardown<stdexec::run_loop>(bench, "run_loop", 2, 2000);
+    teardown<event_loop>(bench, "event_loop", 2, 2000);
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <cstring>
+#include <optional>
+#include <random>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#include "bench.hpp"
+#include "hugepage_arena.hpp"
+
+// A `process_frame`-like kernel over frames in a `frame_buffer_pool` backed by 4k pages, transparent
+// huge pages and hugetlb pages. The kernel reads values at random offsets across all frames, which
+// is what makes TLB reach matter. Besides time per access, the dTLB read misses per access are
+// reported where perf events are available (Linux, perf_event_paranoid <= 2).
+//
+//     hugepage_bench [--frame-bytes N] [--frames N]
+
+// dTLB read misses of the calling thread
+class dtlb_counter {
+public:
+    dtlb_counter() {
+        auto attr = perf_event_attr {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB
+            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    ~dtlb_counter() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool available() const noexcept {
+        return fd_ >= 0;
+    }
+
+    void start() {
+        ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    uint64_t stop() {
+        ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (::read(fd_, &count, sizeof(count)) != sizeof(count)) return 0;
+        return count;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+void run_backing(bench_runner& bench, page_backing requested, std::size_t frame_bytes, std::size_t frames) {
+    // named by the request: a fallback would otherwise add its samples to another backing's metric
+    auto name = std::string("tlb/") + to_string(requested);
+    if (!bench.enabled(name)) return;
+
+    auto pool = frame_buffer_pool(frame_bytes, frames, { .pages = requested, .prefault = true });
+    if (pool.region().backing() != requested) {
+        std::cerr << name << ": got " << to_string(pool.region().backing()) << " pages, skipped" << std::endl;
+        return;
+    }
+
+    // fill the frames through the memory resource, as a decoder would
+    auto buffers = std::vector<int32_t*>();
+    for (std::size_t f = 0; f < frames; ++f) {
+        auto p = static_cast<int32_t*>(pool.allocate(frame_bytes));
+        std::memset(p, int(f), frame_bytes);
+        buffers.push_back(p);
+    }
+
+    const std::size_t accesses = std::size_t(1) << 22;
+    auto rng = std::mt19937_64(7);
+    auto offsets = std::vector<std::pair<uint32_t, uint32_t>>(accesses);
+    for (auto& [frame, offset] : offsets) {
+        frame = static_cast<uint32_t>(rng() % frames);
+        offset = static_cast<uint32_t>(rng() % (frame_bytes / sizeof(int32_t)));
+    }
+
+    auto counter = dtlb_counter();
+    int64_t sink = 0;
+    for (int r = 0; r < bench.repetitions(); ++r) {
+        if (counter.available()) counter.start();
+        auto start = std::chrono::steady_clock::now();
+        for (auto [frame, offset] : offsets) {
+            sink += buffers[frame][offset];
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        bench.record(name + "/access", "ns/op", false, std::chrono::duration<double, std::nano>(elapsed).count() / double(accesses));
+        if (counter.available()) {
+            bench.record(name + "/dtlb_misses", "miss/op", false, double(counter.stop()) / double(accesses));
+        }
+    }
+    if (sink == 42) std::cout << "";
+
+    for (auto p : buffers) pool.deallocate(p, frame_bytes);
+}
+
+int main(int argc, char** argv) {
+    auto bench = bench_runner(argc, argv);
+
+    std::size_t frame_bytes = 1920 * 1080 * 4;
+    std::size_t frames = 32;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string_view(argv[i]) == "--frame-bytes") frame_bytes = std::stoul(argv[i + 1]);
+        if (std::string_view(argv[i]) == "--frames") frames = std::stoul(argv[i + 1]);
+    }
+
+    if (!dtlb_counter().available()) {
+        std::cerr << "dTLB counter unavailable (perf_event_open); reporting time only" << std::endl;
+    }
+
+    for (auto backing : { page_backing::normal, page_backing::transparent_huge, page_backing::hugetlb_2mb, page_backing::hugetlb_1gb }) {
+        run_backing(bench, backing, frame_bytes, frames);
+    }
+
+    return 0;
+}
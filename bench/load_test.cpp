@@ -0,0 +1,553 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <unistd.h>
+#include <exec/async_scope.hpp>
+#include <exec/repeat_effect_until.hpp>
+#include <exec/sequence/ignore_all_values.hpp>
+#include <exec/sequence/iterate.hpp>
+#include <exec/sequence/transform_each.hpp>
+#include <exec/single_thread_context.hpp>
+
+#include "bench.hpp"
+#include "decoder.hpp"
+#include "elastic_thread_pool.hpp"
+#include "event_loop.hpp"
+#include "hdr_histogram.hpp"
+#include "ondemand_range.hpp"
+#include "slab_pool.hpp"
+
+// Load generator for the decode -> cache -> process pipelines of ex01 and ex02.
+//
+// Frames arrive at a fixed offered rate: frame i is due at start + i / rate, whether or not the
+// pipeline is ready for it. Its latency is measured from that due time to the end of processing,
+// so a pipeline that falls behind shows the queueing delay instead of quietly slowing the source.
+// Processing burns `cost` microseconds of CPU per frame. `--closed-loop` instead sends a frame only
+// once the previous one was processed and measures from the send, which is how a naive benchmark
+// hides a slow consumer (coordinated omission); the CSV then also has the p99 corrected for it.
+// Latencies are kept in `hdr_histogram`s, and `--hgrm prefix` writes their percentile distribution
+// in HdrHistogram's format, to plot against an SLO.
+//
+// Sweep mode runs every (architecture, cost, rate) point for `--duration` seconds, `--repetitions`
+// times (default 1, or 5 with `--json`), and writes achieved throughput and latency percentiles per run to a CSV;
+// `--json file` also writes achieved rate and p99 per point as `bench_runner` samples, for
+// `bench_compare`. The knee of a curve is the highest offered rate the pipeline keeps up with
+// (achieved >= 95% of offered) at a p99 under `--p99-slo-us`; past it, latency grows with the run
+// length.
+//
+//     load_test --arch ex01,ex02 --rates 1000,2000,5000,10000 --costs 0,50,200 --csv knee.csv
+//
+// Soak mode runs one point for `--soak` seconds and writes one CSV row per `--interval` with
+// throughput, latency, resident memory and slab chunks, then fails (exit 1) if resident memory
+// grew by more than `--max-growth-mb` over the run after warm-up.
+//
+//     load_test --soak 14400 --arch ex02 --rates 2000 --costs 100 --csv soak.csv
+
+using load_clock = std::chrono::steady_clock;
+
+struct load_point {
+    std::string arch;
+    double rate {};                             // offered frames per second
+    std::chrono::microseconds cost {};          // consumer CPU time per frame
+};
+
+/// Latency of the frames processed in one reporting interval.
+struct interval_stats {
+    std::chrono::duration<double> elapsed {};   // since the run started
+    std::chrono::duration<double> length {};
+    hdr_histogram latency;                      // ns
+    hdr_histogram corrected;                    // ns; closed loop: with the samples its stalls omitted
+
+    double rate() const {
+        return length.count() > 0 ? static_cast<double>(latency.count()) / length.count() : 0;
+    }
+
+    /// Latency at `q` (0 to 1) in microseconds.
+    double percentile(double q) const {
+        return static_cast<double>(latency.value_at_percentile(q * 100)) / 1000;
+    }
+
+    void add(const interval_stats& other) {
+        elapsed = other.elapsed;
+        length += other.length;
+        latency.add(other.latency);
+        corrected.add(other.corrected);
+    }
+
+    void reset() {
+        latency.reset();
+        corrected.reset();
+    }
+};
+
+/// Due times of the offered load and the consumer side of a run: records each processed frame's
+/// latency and hands out the samples once per interval, after the warm-up.
+///
+/// Open loop (the default), frame i is sent at its due time whatever the pipeline is doing, and
+/// its latency runs from that due time. `closed_loop` is the naive measurement for comparison: a
+/// frame is sent only once the previous one was processed (and not before it is due), and latency
+/// runs from the actual send, so time a slow consumer keeps frames from being sent goes unrecorded.
+class load_run {
+public:
+    using report_fn = std::function<void(interval_stats&)>;
+
+    load_run(const load_point& point, bool closed_loop, std::chrono::duration<double> duration,
+             std::chrono::duration<double> warmup, std::chrono::duration<double> interval, report_fn report)
+        : point_(point)
+        , closed_loop_(closed_loop)
+        , start_(load_clock::now() + std::chrono::milliseconds(10)) // room to start the pipeline
+        , end_(start_ + std::chrono::duration_cast<load_clock::duration>(duration))
+        , measured_(start_ + std::chrono::duration_cast<load_clock::duration>(warmup))
+        , interval_(std::chrono::duration_cast<load_clock::duration>(interval))
+        , next_report_(measured_ + interval_)
+        , report_(std::move(report)) {
+    }
+
+    bool closed_loop() const noexcept {
+        return closed_loop_;
+    }
+
+    load_clock::time_point start() const noexcept {
+        return start_;
+    }
+
+    std::chrono::nanoseconds period() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(1 / point_.rate));
+    }
+
+    load_clock::time_point due(std::int64_t frame) const {
+        return start_ + std::chrono::duration_cast<load_clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(frame) / point_.rate));
+    }
+
+    /// Frames due before the end of the run.
+    bool done(std::int64_t next_frame) const {
+        return due(next_frame) >= end_;
+    }
+
+    /// Waits until `frame` may be sent; returns the time its latency is measured from.
+    load_clock::time_point pace(std::int64_t frame) {
+        if (closed_loop_) {
+            for (auto processed = processed_.load(); processed < frame; processed = processed_.load()) {
+                processed_.wait(processed);
+            }
+        }
+        std::this_thread::sleep_until(due(frame));
+        return closed_loop_ ? load_clock::now() : due(frame);
+    }
+
+    /// The consumer's work: burns `cost` of CPU and records the latency since `origin`.
+    void process(load_clock::time_point origin) {
+        auto until = load_clock::now() + point_.cost;
+        while (load_clock::now() < until) {
+        }
+
+        auto now = load_clock::now();
+        last_ = now;
+        if (now >= next_report_) flush(now);
+        if (origin >= measured_) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - origin).count();
+            stats_.latency.record(ns);
+            stats_.corrected.record_corrected(ns, closed_loop_ ? period().count() : 0);
+        }
+
+        if (closed_loop_) {
+            processed_.fetch_add(1);
+            processed_.notify_one();
+        }
+    }
+
+    /// Reports what is left of the last interval, up to the last processed frame.
+    void finish() {
+        flush(last_);
+    }
+
+private:
+    void flush(load_clock::time_point now) {
+        if (now <= measured_) return;
+        auto from = next_report_ - interval_;
+        stats_.elapsed = now - start_;
+        stats_.length = now - std::max(from, measured_);
+        report_(stats_);
+        stats_.reset();
+        while (next_report_ <= now) next_report_ += interval_;
+    }
+
+    load_point point_;
+    bool closed_loop_;
+    load_clock::time_point start_;
+    load_clock::time_point end_;
+    load_clock::time_point measured_;
+    load_clock::duration interval_;
+    load_clock::time_point next_report_;
+    load_clock::time_point last_ {};
+    report_fn report_;
+    interval_stats stats_;
+    std::atomic<std::int64_t> processed_ {};
+};
+
+// ex01: the decoder pushes frames into a locked queue; a reader on an io pool blocks on the queue
+// and hops to the main event_loop to process each frame. A negative index marks the end of the run.
+namespace ex01 {
+
+struct cached_frame {
+    std::int64_t index;
+    load_clock::time_point origin;
+};
+
+struct frame_index_cache {
+    cached_frame read() {
+        auto lock = std::unique_lock(mutex);
+        signal.wait(lock, [&] { return !queue.empty(); });
+        auto frame = queue.front();
+        queue.pop();
+        return frame;
+    }
+
+    void write(cached_frame frame) {
+        {
+            auto lock = std::unique_lock(mutex);
+            queue.push(frame);
+        }
+        signal.notify_one();
+    }
+
+    std::mutex mutex;
+    std::condition_variable signal;
+    std::queue<cached_frame> queue;
+};
+
+void run(load_run& run) {
+    auto io_pool = elastic_thread_pool(elastic_thread_pool::options { .min_threads = 1, .max_threads = 4 });
+    auto io_sched = io_pool.get_scheduler();
+    auto decoder = exec::single_thread_context();
+    auto main_loop = event_loop();
+    auto main_sched = main_loop.get_scheduler();
+    auto scope = exec::async_scope();
+    auto cache = frame_index_cache();
+    std::int64_t next = 0;
+
+    auto decode_and_cache =
+        decoder.get_scheduler().schedule()
+        | stdexec::then([&] {
+            if (run.done(next)) {
+                cache.write({ -1, {} });
+                return true;
+            }
+            auto origin = run.pace(next);
+            cache.write({ next++, origin });
+            return false;
+        })
+        | exec::repeat_effect_until();
+
+    auto reader =
+        io_sched.schedule()
+        | stdexec::let_value([&] {
+            return stdexec::just(&cache)
+                | stdexec::let_value([](frame_index_cache* c) { return stdexec::just(c->read()); })
+                | stdexec::continues_on(main_sched)
+                | stdexec::then([&](cached_frame frame) {
+                    if (frame.index < 0) {
+                        main_loop.finish();
+                        return true;
+                    }
+                    run.process(frame.origin);
+                    return false;
+                })
+                | exec::repeat_effect_until();
+        });
+
+    scope.spawn(std::move(decode_and_cache));
+    scope.spawn(std::move(reader));
+    main_loop.run();
+    stdexec::sync_wait(scope.on_empty());
+}
+
+} // namespace ex01
+
+// ex02: the reader pulls frames from `hw_decoder` through an `ondemand_range` with
+// `exec::iterate`. Open loop, the decoder itself captures frames on schedule (`frame_interval`)
+// and stamps them with the intended capture time; closed loop, the next frame is requested once
+// the previous one was processed.
+namespace ex02 {
+
+void run(load_run& run) {
+    auto read_context = exec::single_thread_context();
+    auto decoder = hw_decoder();
+    decoder.latency = {};
+    if (!run.closed_loop()) {
+        decoder.frame_interval = run.period();
+        decoder.first_capture = run.start();
+    }
+    std::int64_t requested = 0;
+    auto sent = load_clock::time_point {};
+
+    auto frames = ondemand_sequence<hw_frame>(
+        [&] {
+            if (run.closed_loop()) {
+                sent = run.pace(requested);
+            }
+            ++requested;
+            return async_decode_frame<hw_frame>(&decoder);
+        },
+        [&] { return stdexec::just(run.done(requested)); });
+
+    auto reader =
+        read_context.get_scheduler().schedule()
+        | stdexec::let_value([&] {
+            return exec::iterate(std::move(frames))
+                | exec::transform_each(stdexec::then([&](auto&& frame) {
+                    run.process(run.closed_loop() ? sent : frame.capture_time);
+                }))
+                | exec::ignore_all_values();
+        });
+
+    stdexec::sync_wait(std::move(reader));
+}
+
+} // namespace ex02
+
+void run_point(load_run& run, const std::string& arch) {
+    if (arch == "ex01") {
+        ex01::run(run);
+    } else if (arch == "ex02") {
+        ex02::run(run);
+    } else {
+        throw std::invalid_argument("unknown architecture " + arch + " (ex01, ex02)");
+    }
+    run.finish();
+}
+
+/// Resident set size in KiB, or 0 where /proc is not available.
+std::size_t resident_kib() {
+    auto statm = std::ifstream("/proc/self/statm");
+    std::size_t pages = 0, resident = 0;
+    if (!(statm >> pages >> resident)) return 0;
+    return resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+template <typename T>
+std::vector<T> parse_list(std::string_view text) {
+    auto values = std::vector<T>();
+    auto in = std::istringstream(std::string(text));
+    for (std::string item; std::getline(in, item, ',');) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            values.push_back(item);
+        } else {
+            values.push_back(static_cast<T>(std::stod(item)));
+        }
+    }
+    return values;
+}
+
+struct load_options {
+    std::vector<std::string> archs { "ex01", "ex02" };
+    std::vector<double> rates { 500, 1000, 2000, 5000, 10000, 20000, 50000 };
+    std::vector<double> costs_us { 0, 20, 100 };
+    double duration = 3;                        // seconds per sweep point
+    double warmup = 0.5;
+    double soak = 0;                            // soak mode when > 0
+    double interval = 10;                       // soak reporting interval
+    double p99_slo_us = 10000;                  // the knee is the highest rate that keeps p99 under this
+    double max_growth_mb = 16;
+    bool closed_loop = false;
+    std::string csv_path = "load_test.csv";
+    std::string hgrm_prefix;                    // HdrHistogram percentile files: one per sweep point, or the whole soak
+};
+
+void sweep(const load_options& opts, bench_runner& bench) {
+    auto csv = std::ofstream(opts.csv_path);
+    csv << "arch,cost_us,offered_rate,repetition,achieved_rate,p50_us,p90_us,p99_us,p999_us,max_us,frames,p99_corrected_us\n";
+    std::cout << std::left << std::setw(6) << "arch" << std::right << std::setw(10) << "cost_us"
+              << std::setw(12) << "offered" << std::setw(12) << "achieved" << std::setw(12) << "p50_us"
+              << std::setw(12) << "p99_us" << std::setw(12) << "max_us" << std::endl;
+
+    for (auto& arch : opts.archs) {
+        for (auto cost : opts.costs_us) {
+            auto knee = 0.0;
+            for (auto rate : opts.rates) {
+                auto point = load_point { arch, rate, std::chrono::microseconds(static_cast<int64_t>(cost)) };
+                auto name = arch + "/cost" + std::to_string(static_cast<int64_t>(cost)) + "us/rate"
+                          + std::to_string(static_cast<int64_t>(rate));
+                if (!bench.enabled(name)) continue;
+                auto achieved = std::vector<double>();
+                auto p50 = std::vector<double>();
+                auto p99 = std::vector<double>();
+                auto max = std::vector<double>();
+                auto all = interval_stats(); // every repetition, for the percentile file
+
+                for (int r = 0; r < bench.repetitions(); ++r) {
+                    auto result = interval_stats();
+                    auto run = load_run(point, opts.closed_loop, std::chrono::duration<double>(opts.duration),
+                                        std::chrono::duration<double>(opts.warmup), std::chrono::duration<double>(opts.duration),
+                                        [&](interval_stats& s) { result.add(s); });
+                    run_point(run, arch);
+                    all.add(result);
+
+                    achieved.push_back(result.rate());
+                    p50.push_back(result.percentile(0.5));
+                    p99.push_back(result.percentile(0.99));
+                    max.push_back(result.percentile(1.0));
+                    bench.record(name + "/achieved", "frames/s", true, achieved.back());
+                    bench.record(name + "/p99", "us", false, p99.back());
+
+                    csv << arch << "," << cost << "," << rate << "," << r << "," << achieved.back() << "," << p50.back() << ","
+                        << result.percentile(0.9) << "," << p99.back() << "," << result.percentile(0.999) << ","
+                        << max.back() << "," << result.latency.count() << ","
+                        << static_cast<double>(result.corrected.value_at_percentile(99)) / 1000 << "\n";
+                }
+
+                if (!opts.hgrm_prefix.empty()) {
+                    auto file = opts.hgrm_prefix + name + ".hgrm";
+                    std::replace(file.begin() + static_cast<std::ptrdiff_t>(opts.hgrm_prefix.size()), file.end(), '/', '-');
+                    auto out = std::ofstream(file);
+                    all.latency.write_percentiles(out);
+                }
+
+                auto median_achieved = bench_runner::median(achieved);
+                auto median_p99 = bench_runner::median(p99);
+                auto saturated = median_achieved < 0.95 * rate;
+                auto within_slo = !saturated && median_p99 <= opts.p99_slo_us;
+                if (within_slo) knee = rate;
+
+                std::cout << std::left << std::setw(6) << arch << std::right << std::fixed << std::setprecision(1)
+                          << std::setw(10) << cost << std::setw(12) << rate << std::setw(12) << median_achieved
+                          << std::setw(12) << bench_runner::median(p50) << std::setw(12) << median_p99
+                          << std::setw(12) << bench_runner::median(max)
+                          << (saturated ? "  saturated" : within_slo ? "" : "  over slo") << std::endl;
+                if (saturated && median_achieved < 0.5 * rate) break; // far past the knee
+            }
+            std::cout << "knee " << arch << " cost " << cost << "us: " << knee << " frames/s with p99 under "
+                      << opts.p99_slo_us << "us" << std::endl;
+        }
+    }
+    std::cout << "wrote " << opts.csv_path << std::endl;
+}
+
+// least-squares slope of resident memory over time, in MiB per hour
+double growth_mb_per_hour(const std::vector<std::pair<double, double>>& samples) {
+    if (samples.size() < 2) return 0;
+    auto n = static_cast<double>(samples.size());
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (auto [x, y] : samples) {
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    auto denominator = n * sxx - sx * sx;
+    return denominator > 0 ? (n * sxy - sx * sy) / denominator / 1024 * 3600 : 0;
+}
+
+int soak(const load_options& opts) {
+    auto point = load_point { opts.archs.front(), opts.rates.front(),
+                              std::chrono::microseconds(static_cast<int64_t>(opts.costs_us.front())) };
+    auto csv = std::ofstream(opts.csv_path);
+    csv << "elapsed_s,achieved_rate,p50_us,p99_us,max_us,resident_kib,slab_chunks\n";
+    std::cout << "soak " << point.arch << " at " << point.rate << " frames/s, cost " << point.cost.count()
+              << "us, for " << opts.soak << "s" << std::endl;
+
+    // resident memory after warm-up, sampled once per interval
+    auto memory = std::vector<std::pair<double, double>>();
+    auto all = interval_stats();
+    auto run = load_run(point, opts.closed_loop, std::chrono::duration<double>(opts.soak),
+                        std::chrono::duration<double>(opts.warmup), std::chrono::duration<double>(opts.interval),
+                        [&](interval_stats& s) {
+                            all.add(s);
+                            auto resident = resident_kib();
+                            memory.emplace_back(s.elapsed.count(), static_cast<double>(resident));
+                            auto p50 = s.percentile(0.5);
+                            csv << s.elapsed.count() << "," << s.rate() << "," << p50 << "," << s.percentile(0.99) << ","
+                                << s.percentile(1.0) << "," << resident << "," << slab_pool::chunk_count() << std::endl;
+                            std::cout << std::fixed << std::setprecision(1) << s.elapsed.count() << "s: " << s.rate()
+                                      << " frames/s, p50 " << p50 << "us, p99 " << s.percentile(0.99) << "us, rss "
+                                      << resident << " KiB" << std::endl;
+                        });
+    run_point(run, point.arch);
+
+    if (!opts.hgrm_prefix.empty()) {
+        auto out = std::ofstream(opts.hgrm_prefix + "soak.hgrm");
+        all.latency.write_percentiles(out);
+    }
+
+    if (memory.size() < 2 || memory.front().second == 0) {
+        std::cout << "too few samples to check memory growth" << std::endl;
+        return 0;
+    }
+    auto growth_mb = (memory.back().second - memory.front().second) / 1024;
+    std::cout << "resident memory grew " << growth_mb << " MiB (" << growth_mb_per_hour(memory) << " MiB/h)" << std::endl;
+    if (growth_mb > opts.max_growth_mb) {
+        std::cout << "FAIL: more than " << opts.max_growth_mb << " MiB" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    auto opts = load_options();
+    auto json = false;
+    for (int i = 1; i < argc; i += 2) {
+        auto arg = std::string_view(argv[i]);
+        if (arg == "--closed-loop") {
+            opts.closed_loop = true;
+            --i;
+            continue;
+        }
+        if (i + 1 == argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 2;
+        }
+        auto value = std::string_view(argv[i + 1]);
+        if (arg == "--json" || arg == "--repetitions" || arg == "--filter") {
+            json = json || arg == "--json";
+            continue; // bench_runner's
+        } else if (arg == "--arch") {
+            opts.archs = parse_list<std::string>(value);
+        } else if (arg == "--rates") {
+            opts.rates = parse_list<double>(value);
+        } else if (arg == "--costs") {
+            opts.costs_us = parse_list<double>(value);
+        } else if (arg == "--duration") {
+            opts.duration = std::stod(std::string(value));
+        } else if (arg == "--warmup") {
+            opts.warmup = std::stod(std::string(value));
+        } else if (arg == "--soak") {
+            opts.soak = std::stod(std::string(value));
+        } else if (arg == "--interval") {
+            opts.interval = std::stod(std::string(value));
+        } else if (arg == "--p99-slo-us") {
+            opts.p99_slo_us = std::stod(std::string(value));
+        } else if (arg == "--max-growth-mb") {
+            opts.max_growth_mb = std::stod(std::string(value));
+        } else if (arg == "--hgrm") {
+            opts.hgrm_prefix = value;
+        } else if (arg == "--csv") {
+            opts.csv_path = value;
+        } else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    if (opts.soak > 0) return soak(opts);
+    // bench_compare needs several samples per point to find anything significant
+    auto bench = bench_runner(argc, argv, json ? 5 : 1);
+    sweep(opts, bench);
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "metrics.hpp"
+
+// Cost of a metric update on the hot path, alone and with several threads updating the same
+// metric (where sharding keeps them off each other's cache lines), plus the cost of a dump.
+
+template <typename Body>
+void run_threads(std::size_t threads, std::size_t n, Body body) {
+    auto workers = std::vector<std::thread>();
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] { body(n); });
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+int main(int argc, char** argv) {
+    auto bench = bench_runner(argc, argv);
+    auto registry = metrics_registry();
+
+    auto& counter = registry.counter("bench_counter_total", "counter");
+    auto& gauge = registry.gauge("bench_gauge", "gauge");
+    auto& histogram = registry.histogram("bench_latency_seconds", "histogram", metric_histogram::exponential_bounds(1e-6, 2, 24));
+
+    const std::size_t iterations = 10'000'000;
+
+    bench.run("counter/add", iterations, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) counter.add();
+    });
+
+    bench.run("gauge/add", iterations, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) gauge.add();
+    });
+
+    bench.run("histogram/observe", iterations, [&](std::size_t n) {
+        auto value = 1e-6;
+        for (std::size_t i = 0; i < n; ++i) {
+            histogram.observe(value);
+            value = value < 1.0 ? value * 1.01 : 1e-6;
+        }
+    });
+
+    // per update, per thread
+    for (std::size_t threads : { 2, 4 }) {
+        bench.run("counter/add_" + std::to_string(threads) + "_threads", iterations, [&](std::size_t n) {
+            run_threads(threads, n, [&](std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) counter.add();
+            });
+        });
+    }
+
+    for (int i = 0; i < 50; ++i) {
+        registry.counter("bench_series_total", "series", "id=\"" + std::to_string(i) + "\"").add();
+    }
+    bench.run("dump", 1000, [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            auto text = registry.to_string();
+            asm volatile("" : : "r"(text.data()) : "memory");
+        }
+    });
+
+    return 0;
+}
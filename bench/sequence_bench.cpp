@@ -0,0 +1,175 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <optional>
+#include <random>
+#include <string>
+
+#include "bench.hpp"
+#include "decoder.hpp"
+#include "frame_dedup.hpp"
+#include "frame_diff.hpp"
+#include "sequence_combine.hpp"
+#include "sequence_ops.hpp"
+
+// Cost of the sequence adaptors in front of `exec::iterate`. Each case drains a prepared vector
+// of frames through the adaptor and reports time per input frame; "passthrough" drains it through a
+// bare `upstream_cursor` and is the baseline the adaptors are compared against. The "small" cases use
+// 16-value frames so that the per-item overhead of the operators dominates.
+//
+// "teardown" cases destroy a combinator after one item, while its pullers are blocked on full
+// rings; they time the destructor, and hang if a cancel is lost.
+
+std::vector<hw_frame> make_frames(std::size_t count, std::size_t size, std::size_t run_length) {
+    auto rng = std::mt19937(42);
+    auto frames = std::vector<hw_frame>();
+    frames.reserve(count);
+    for (std::size_t f = 0; f < count; ++f) {
+        // every `run_length` consecutive frames share a payload
+        auto data = hw_frame::data_type(size);
+        auto scene = static_cast<int32_t>(f / run_length);
+        for (std::size_t i = 0; i < size; ++i) {
+            data[i] = scene + static_cast<int32_t>(rng() & 0xff);
+        }
+        if (f % run_length) {
+            data = frames.back().data;
+        }
+        frames.emplace_back(static_cast<int>(f), std::move(data));
+    }
+    return frames;
+}
+
+std::vector<hw_frame> copy_frames(const std::vector<hw_frame>& frames) {
+    auto copy = std::vector<hw_frame>();
+    copy.reserve(frames.size());
+    for (auto& frame : frames) {
+        copy.emplace_back(frame.index, frame.data);
+    }
+    return copy;
+}
+
+// drain `frames` through `make_view` once per repetition; records ns per input frame
+template <typename MakeView>
+void run_sequence(bench_runner& bench, const std::string& name, const std::vector<hw_frame>& frames, MakeView make_view) {
+    if (!bench.enabled(name)) return;
+
+    for (int r = 0; r < bench.repetitions(); ++r) {
+        auto input = copy_frames(frames);
+        auto start = std::chrono::steady_clock::now();
+
+        auto view = make_view(std::move(input));
+        for (auto it = view.begin(); it != view.end(); ++it) {
+            auto item = *it;
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        bench.record(name, "ns/frame", false, std::chrono::duration<double, std::nano>(elapsed).count() / double(frames.size()));
+    }
+}
+
+// pull one item from `make_view`'s view, then destroy it; records ns per teardown
+template <typename MakeView>
+void run_teardown(bench_runner& bench, const std::string& name, const std::vector<hw_frame>& frames, std::size_t iterations, MakeView make_view) {
+    if (!bench.enabled(name)) return;
+
+    for (int r = 0; r < bench.repetitions(); ++r) {
+        auto elapsed = std::chrono::steady_clock::duration {};
+        for (std::size_t i = 0; i < iterations; ++i) {
+            auto view = std::optional(make_view(copy_frames(frames)));
+            auto it = view->begin();
+            auto item = *it;
+
+            auto start = std::chrono::steady_clock::now();
+            view.reset();
+            elapsed += std::chrono::steady_clock::now() - start;
+        }
+        bench.record(name, "ns/teardown", false, std::chrono::duration<double, std::nano>(elapsed).count() / double(iterations));
+    }
+}
+
+void run_hash(bench_runner& bench, std::size_t bytes) {
+    auto name = "hash/" + std::to_string(bytes / 1024) + "KiB";
+    if (!bench.enabled(name)) return;
+
+    auto data = std::vector<std::byte>(bytes, std::byte { 0x5a });
+    auto iterations = std::max<std::size_t>(1, (std::size_t(256) << 20) / bytes);
+    uint64_t sink = 0;
+
+    for (int r = 0; r < bench.repetitions(); ++r) {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            sink += frame_hash64(data, sink);
+        }
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        bench.record(name, "GB/s", true, double(bytes * iterations) / seconds / 1e9);
+    }
+
+    if (sink == 42) std::cout << ""; // keep the hash alive
+}
+
+int main(int argc, char** argv) {
+    auto bench = bench_runner(argc, argv);
+
+    for (auto bytes : { std::size_t(4) << 10, std::size_t(256) << 10, std::size_t(8) << 20 }) {
+        run_hash(bench, bytes);
+    }
+
+    const std::size_t count = 256;
+    const std::size_t size = 1920 * 1080 / 4;
+    auto changing = make_frames(count, size, 1);
+    auto mostly_static = make_frames(count, size, 16);
+
+    auto passthrough = [](auto frames) {
+        return make_pull_view<hw_frame>([upstream = upstream_cursor(std::views::all(std::move(frames)))]() mutable {
+            return upstream.next();
+        });
+    };
+    auto deduped = [](auto frames) { return std::move(frames) | dedup(); };
+
+    run_sequence(bench, "passthrough/changing", changing, passthrough);
+    run_sequence(bench, "dedup/changing", changing, deduped);
+    run_sequence(bench, "dedup/static16", mostly_static, deduped);
+
+    auto diffed = [](auto frames) { return std::move(frames) | diff_tiles(1024); };
+    run_sequence(bench, "diff_tiles/changing", changing, diffed);
+    run_sequence(bench, "diff_tiles/static16", mostly_static, diffed);
+
+    auto small = make_frames(100000, 16, 1);
+    run_sequence(bench, "passthrough/small", small, passthrough);
+    run_sequence(bench, "chunk8/small", small, [](auto frames) { return std::move(frames) | chunk(8); });
+    run_sequence(bench, "window8_1/small", small, [](auto frames) { return std::move(frames) | window(8, 1); });
+    run_sequence(bench, "sample4/small", small, [](auto frames) { return std::move(frames) | sample(4); });
+    run_sequence(bench, "buffer64/small", small, [](auto frames) { return std::move(frames) | buffer(64); });
+    // a rate no stream reaches: measures the bookkeeping, not the delay
+    run_sequence(bench, "throttle/small", small, [](auto frames) { return std::move(frames) | throttle(1e12); });
+
+    // two upstreams of half the frames each; zip pairs them by index
+    auto half = [](auto frames) {
+        auto second = std::vector<hw_frame>();
+        for (auto i = frames.size() / 2; i < frames.size(); ++i) {
+            second.emplace_back(frames[i].index - static_cast<int>(frames.size() / 2), std::move(frames[i].data));
+        }
+        frames.erase(frames.begin() + static_cast<std::ptrdiff_t>(frames.size() / 2), frames.end());
+        return std::pair(std::move(frames), std::move(second));
+    };
+    run_sequence(bench, "merge2/small", small, [&](auto frames) {
+        auto [a, b] = half(std::move(frames));
+        return merge(std::move(a), std::move(b));
+    });
+    run_sequence(bench, "zip2/small", small, [&](auto frames) {
+        auto [a, b] = half(std::move(frames));
+        return zip(std::move(a), std::move(b));
+    });
+
+    // rings of one slot: the pullers are blocked on them, or about to be, when the view goes
+    auto few = make_frames(64, 16, 1);
+    run_teardown(bench, "merge2/teardown", few, 200, [&](auto frames) {
+        auto [a, b] = half(std::move(frames));
+        return merge_with_capacity(1, nullptr, std::move(a), std::move(b));
+    });
+    run_teardown(bench, "zip2/teardown", few, 200, [&](auto frames) {
+        auto [a, b] = half(std::move(frames));
+        return zip_with_capacity(1, nullptr, nullptr, std::move(a), std::move(b));
+    });
+
+    return 0;
+}
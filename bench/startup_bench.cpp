@@ -0,0 +1,68 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <fstream>
+#include <memory>
+#include <exec/single_thread_context.hpp>
+
+#include "bench.hpp"
+#include "decoder.hpp"
+
+// Cost of configuring many decoders of which few are busy: eager `single_thread_context` decoders
+// start a thread each at construction, `lazy_thread_context` decoders (the `hw_decoder` default) do not.
+
+using eager_decoder = basic_hw_decoder<exec::single_thread_context>;
+
+/// Threads in this process, or 0 where /proc is not available.
+std::size_t process_threads() {
+    auto status = std::ifstream("/proc/self/status");
+    for (std::string line; std::getline(status, line);) {
+        if (line.starts_with("Threads:")) {
+            return std::stoul(line.substr(8));
+        }
+    }
+    return 0;
+}
+
+template <typename Decoder>
+void startup(bench_runner& bench, const std::string& kind, std::size_t count) {
+    auto name = "startup/" + kind + "/" + std::to_string(count);
+    if (!bench.enabled(name)) return;
+
+    for (int r = 0; r < bench.repetitions(); ++r) {
+        auto decoders = std::vector<std::unique_ptr<Decoder>>();
+        decoders.reserve(count);
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < count; ++i) {
+            decoders.push_back(std::make_unique<Decoder>());
+        }
+        auto constructed = std::chrono::steady_clock::now();
+
+        bench.record(name + "/construct", "ms", false,
+            std::chrono::duration<double, std::milli>(constructed - start).count());
+        bench.record(name + "/threads", "threads", false, static_cast<double>(process_threads()));
+
+        // first frame from an idle decoder pays for starting its thread
+        decoders.front()->latency = {};
+        auto first = std::chrono::steady_clock::now();
+        stdexec::sync_wait(async_decode_frame<hw_frame>(decoders.front().get()));
+        bench.record(name + "/first_frame", "us", false,
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - first).count());
+
+        auto teardown = std::chrono::steady_clock::now();
+        decoders.clear();
+        bench.record(name + "/destroy", "ms", false,
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - teardown).count());
+    }
+}
+
+int main(int argc, char** argv) {
+    auto bench = bench_runner(argc, argv);
+
+    for (std::size_t count : { 1, 10, 100, 1000 }) {
+        startup<eager_decoder>(bench, "eager", count);
+        startup<hw_decoder>(bench, "lazy", count);
+    }
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <string>
+#include <thread>
+
+#include "bench.hpp"
+#include "event_loop.hpp"
+#include "hdr_histogram.hpp"
+#include "wait_strategy.hpp"
+
+using namespace std::chrono_literals;
+
+// Latency against CPU use of the `wait_strategy`s, on an `event_loop` fed by one producer thread.
+//
+// The producer starts a hop, waits until it ran, sleeps for `gap` and starts the next, so the loop
+// is idle between hops: with `park` every hop is a kernel wake-up, with spinning the loop may
+// still be polling when the hop arrives. Per strategy and gap:
+//
+//   p50, p99: ns from starting the hop to running it on the loop's thread
+//   loop_cpu: CPU time of the loop's thread, in percent of the wall time
+//
+// Spinning only helps when producer and loop have a core each; on a single CPU it mostly costs.
+
+struct hop_receiver {
+    using receiver_concept = stdexec::receiver_t;
+
+    void set_value() noexcept {
+        latency->record((std::chrono::steady_clock::now() - *sent).count());
+        ran->fetch_add(1, std::memory_order_release);
+        ran->notify_one();
+        if (last) loop->finish();
+    }
+
+    void set_stopped() noexcept {
+    }
+
+    event_loop* loop;
+    std::atomic<uint32_t>* ran;
+    hdr_histogram* latency;
+    std::chrono::steady_clock::time_point* sent;
+    bool last;
+};
+
+struct hop {
+    using sender_t = decltype(stdexec::schedule(std::declval<event_loop&>().get_scheduler()));
+
+    hop(event_loop& loop, hop_receiver receiver)
+        : op(stdexec::connect(stdexec::schedule(loop.get_scheduler()), receiver)) {}
+
+    stdexec::connect_result_t<sender_t, hop_receiver> op;
+};
+
+double thread_cpu_seconds() {
+    auto ts = timespec {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+void handoff(bench_runner& bench, const std::string& strategy_name, wait_strategy strategy,
+             std::chrono::microseconds gap, uint32_t hops) {
+    auto name = strategy_name + "/gap" + std::to_string(gap.count()) + "us";
+    if (!bench.enabled(name)) return;
+
+    for (int r = 0; r < bench.repetitions(); ++r) {
+        auto loop = event_loop(strategy);
+        auto ran = std::atomic<uint32_t> { 0 };
+        auto latency = hdr_histogram();
+        auto sent = std::chrono::steady_clock::time_point {};
+
+        // deque: operation states do not move
+        auto ops = std::deque<hop>();
+        for (uint32_t i = 0; i < hops; ++i) ops.emplace_back(loop, hop_receiver { &loop, &ran, &latency, &sent, i + 1 == hops });
+
+        auto producer = std::thread([&] {
+            for (uint32_t i = 0; i < hops; ++i) {
+                if (gap.count()) std::this_thread::sleep_for(gap);
+                sent = std::chrono::steady_clock::now();
+                stdexec::start(ops[i].op);
+                ran.wait(i, std::memory_order_acquire);
+            }
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        auto cpu_start = thread_cpu_seconds();
+        loop.run();
+        auto cpu = thread_cpu_seconds() - cpu_start;
+        auto wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        producer.join();
+
+        bench.record(name + "/p50", "ns", false, static_cast<double>(latency.value_at_percentile(50)));
+        bench.record(name + "/p99", "ns", false, static_cast<double>(latency.value_at_percentile(99)));
+        bench.record(name + "/loop_cpu", "%", false, cpu / wall * 100);
+    }
+}
+
+int main(int argc, char** argv) {
+    auto bench = bench_runner(argc, argv);
+
+    struct named_strategy {
+        std::string name;
+        wait_strategy strategy;
+    };
+    auto strategies = {
+        named_strategy { "park", wait_strategy::park() },
+        named_strategy { "spin200", wait_strategy::spin_then_park(200, 0) },
+        named_strategy { "spin2000_yield16", wait_strategy::spin_then_park() },
+        named_strategy { "spin20000_yield64", wait_strategy::spin_then_park(20000, 64) },
+    };
+
+    for (auto& s : strategies) {
+        handoff(bench, s.name, s.strategy, 0us, 20000);
+        handoff(bench, s.name, s.strategy, 50us, 5000);
+    }
+
+    return 0;
+}
@@ -5,7 +5,11 @@
 #include <exec/async_scope.hpp>
 #include <exec/repeat_effect_until.hpp>
 #include <exec/single_thread_context.hpp>
-#include <exec/static_thread_pool.hpp>
+
+#include "elastic_thread_pool.hpp"
+#include "event_loop.hpp"
+#include "metrics.hpp"
+#include "wait_strategy.hpp"
 
 /// A mock HW decoder.
 struct hw_decoder
@@ -82,6 +86,9 @@ stdexec::sender auto async_decode_frame(hw_decoder* decoder) {
 
 struct frame_index_cache {
     auto read() {
+        // with a spinning `wait`, catch the next write before taking the lock and sleeping on `signal`
+        wait.poll([this] { return available.load(std::memory_order_acquire) > 0; });
+
         auto lock = std::unique_lock(mutex);
 
         signal.wait(lock, [&, this] { 
@@ -90,6 +97,9 @@ struct frame_index_cache {
 
         auto frameIndex = queue.front();
         queue.pop();
+        available.store(queue.size(), std::memory_order_relaxed);
+        reads.add();
+        depth.sub();
         signal.notify_all();
         std::cout << "after read: i,qsize, " << frameIndex << "," << queue.size() << std::endl;
         return frameIndex;
@@ -99,6 +109,9 @@ struct frame_index_cache {
         auto lock = std::unique_lock(mutex);
 
         queue.push(frameIndex);
+        available.store(queue.size(), std::memory_order_release);
+        writes.add();
+        depth.add();
         signal.notify_all();
         std::cout << "after write: i,qsize, " << frameIndex << "," << queue.size() << std::endl;
     }
@@ -106,6 +119,12 @@ struct frame_index_cache {
     std::mutex mutex;
     std::condition_variable signal;
     std::queue<int> queue;
+    std::atomic<std::size_t> available {};  // queue.size(), for polling without the lock
+    wait_strategy wait;
+
+    metric_counter& writes = metrics_registry::global().counter("frame_index_cache_writes_total", "Frame indices written to the cache.");
+    metric_counter& reads = metrics_registry::global().counter("frame_index_cache_reads_total", "Frame indices read from the cache.");
+    metric_gauge& depth = metrics_registry::global().gauge("frame_index_cache_depth", "Frame indices waiting in the cache.");
 };
 
 stdexec::sender auto asyncRead(frame_index_cache* frame_cache)
@@ -114,10 +133,14 @@ stdexec::sender auto asyncRead(frame_index_cache* frame_cache)
 }
 
 int main() {
-    auto io_pool = exec::static_thread_pool(2);
+    // grows past the two long-running loops when work queues up, shrinks back when idle
+    auto io_pool = elastic_thread_pool(elastic_thread_pool::options {
+        .min_threads = 1,
+        .max_threads = 4,
+    });
     auto io_sched = io_pool.get_scheduler();
 
-    auto main_loop = stdexec::run_loop();
+    auto main_loop = event_loop(wait_strategy::spin_then_park());
     auto main_sched = main_loop.get_scheduler();
 
     auto main_scope = exec::async_scope();
@@ -126,6 +149,9 @@ int main() {
     auto decoder = hw_decoder();
     auto frame_cache = frame_index_cache();
 
+    // the reader and the main loop spin briefly before sleeping: every frame passes both
+    frame_cache.wait = wait_strategy::spin_then_park();
+
     const int limit = 100000;
     int count = limit;
 
@@ -176,5 +202,7 @@ int main() {
 
     stdexec::sync_wait(main_scope.on_empty());
 
+    std::cout << metrics_registry::global().to_string();
+
     return 0;
 }
@@ -0,0 +1,124 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/// Progress of a frame pipeline: the last fully processed frame and the reducer state at that point.
+struct pipeline_checkpoint {
+    int32_t last_index { -1 };
+    int64_t total {};
+};
+
+/// Persists `pipeline_checkpoint`s so that a restarted pipeline resumes instead of starting from frame 0.
+///
+/// `update` is called after each processed frame and writes the checkpoint every `every_frames` frames
+/// or `every` interval, whichever comes first; a crash replays at most that many frames.
+/// Each write goes to `<path>.tmp`, is fsync'ed and renamed over `<path>`, and the directory is fsync'ed
+/// so the rename itself survives a crash: the file always holds either the previous or the new
+/// checkpoint, never a torn one.
+class checkpoint_file {
+public:
+    explicit checkpoint_file(std::filesystem::path path,
+                             int every_frames = 100,
+                             std::chrono::milliseconds every = std::chrono::milliseconds(1000))
+        : path_(std::move(path)), every_frames_(every_frames), every_(every) {
+    }
+
+    ~checkpoint_file() {
+        try {
+            flush();
+        } catch (...) {
+            // best effort; the previous checkpoint is still intact
+        }
+    }
+
+    // non-copyable
+    checkpoint_file(const checkpoint_file&) = delete;
+    checkpoint_file& operator=(const checkpoint_file&) = delete;
+
+    /// The last saved checkpoint, if there is one.
+    std::optional<pipeline_checkpoint> load() const {
+        auto in = std::ifstream(path_);
+        auto magic = std::string();
+        auto checkpoint = pipeline_checkpoint {};
+        if (in >> magic >> checkpoint.last_index >> checkpoint.total && magic == "frame_checkpoint_v1") {
+            return checkpoint;
+        }
+        return std::nullopt;
+    }
+
+    /// Record progress; written out when due.
+    void update(const pipeline_checkpoint& checkpoint) {
+        pending_ = checkpoint;
+        auto now = std::chrono::steady_clock::now();
+        if (++frames_since_save_ >= every_frames_ || now - last_save_ >= every_) {
+            save(checkpoint);
+        }
+    }
+
+    /// Write the last recorded progress if it has not been saved yet.
+    void flush() {
+        if (pending_ && frames_since_save_ > 0) {
+            save(*pending_);
+        }
+    }
+
+    void save(const pipeline_checkpoint& checkpoint) {
+        auto tmp_path = path_;
+        tmp_path += ".tmp";
+
+        auto text = "frame_checkpoint_v1 " + std::to_string(checkpoint.last_index) + " "
+            + std::to_string(checkpoint.total) + "\n";
+
+        int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::system_error(errno, std::system_category(), "open " + tmp_path.string());
+        }
+        auto ok = ::write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size()) && ::fsync(fd) == 0;
+        auto err = errno;
+        ::close(fd);
+        if (!ok) {
+            throw std::system_error(err, std::system_category(), "write " + tmp_path.string());
+        }
+
+        std::filesystem::rename(tmp_path, path_);
+        sync_directory();
+
+        frames_since_save_ = 0;
+        last_save_ = std::chrono::steady_clock::now();
+    }
+
+private:
+    // the rename is only durable once the directory entry is on disk
+    void sync_directory() {
+        auto dir = path_.parent_path();
+        if (dir.empty()) dir = ".";
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::system_category(), "open " + dir.string());
+        }
+        auto ok = ::fsync(fd) == 0;
+        auto err = errno;
+        ::close(fd);
+        if (!ok) {
+            throw std::system_error(err, std::system_category(), "fsync " + dir.string());
+        }
+    }
+
+    std::filesystem::path path_;
+    int every_frames_;
+    std::chrono::milliseconds every_;
+    std::optional<pipeline_checkpoint> pending_;
+    int frames_since_save_ {};
+    std::chrono::steady_clock::time_point last_save_ { std::chrono::steady_clock::now() };
+};
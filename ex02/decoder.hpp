@@ -1,90 +1,277 @@
 // Copyright (c) 2025 Peter Tran. All rights reserved.
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <utility>
 #include <exec/any_sender_of.hpp>
 #include <exec/async_scope.hpp>
-#include <exec/single_thread_context.hpp>
+
+#include "elastic_thread_pool.hpp"
+#include "frame_header.hpp"
+#include "metrics.hpp"
+#include "pooled_spawn.hpp"
 
 /// Simulated frame data structure.
 /// A heavyweight resource intended to be move-only.
-struct hw_frame {
-    int index;
-    std::vector<int32_t> data; // Simulated frame data
+/// The fixed `frame_header` (index, flags, capture time) sits in front of the payload; optional
+/// per-frame data is attached with `metadata()` and released with the frame.
+///
+/// The payload is allocated from a `std::pmr::memory_resource` (the default resource unless given),
+/// e.g. a monotonic arena for a batch job, a pool resource for streaming or a `frame_buffer_pool`
+/// for large frames. The resource must outlive the frame.
+struct hw_frame : frame_header {
+    using data_type = std::pmr::vector<int32_t>;
+
+    data_type data; // Simulated frame data
+
+    hw_frame(int idx, data_type d, frame_clock::time_point captured = {})
+        : frame_header { .index = idx, .capture_time = captured }, data(std::move(d)) {}
+
+    // e.g. a header received from another process
+    hw_frame(const frame_header& header, data_type d) : frame_header(header.detached()), data(std::move(d)) {}
+
+    ~hw_frame() {
+        release_metadata();
+    }
 
-    hw_frame(int idx, std::vector<int32_t> d) : index(idx), data(std::move(d)) {}
-    ~hw_frame() = default;
+    //move-only; the payload keeps the resource it was allocated from
+    hw_frame(hw_frame&& other) noexcept : frame_header(other), data(std::move(other.data)) {
+        other.meta_slot = no_metadata;
+    }
+
+    hw_frame& operator=(hw_frame&& other) noexcept {
+        if (this != &other) {
+            release_metadata();
+            static_cast<frame_header&>(*this) = other;
+            // take over the buffer even across resources; pmr's assignment would copy into ours
+            std::destroy_at(&data);
+            std::construct_at(&data, std::move(other.data));
+            other.meta_slot = no_metadata;
+        }
+        return *this;
+    }
 
-    //move-only
-    hw_frame(hw_frame&&) = default;
-    hw_frame& operator=(hw_frame&&) = default;
     hw_frame(const hw_frame&) = delete;
     hw_frame& operator=(const hw_frame&) = delete;
+
+    // no `allocator_type`: frames are not uses-allocator constructible, so containers must not
+    // try to pass them their resource
+    data_type::allocator_type get_allocator() const noexcept {
+        return data.get_allocator();
+    }
+
+    /// This frame's metadata entry, attached on first use.
+    frame_metadata& metadata() {
+        auto& table = frame_metadata_table::instance();
+        if (meta_slot == no_metadata) {
+            meta_slot = table.acquire();
+        }
+        return table[meta_slot];
+    }
+
+    /// nullptr if no metadata was attached.
+    const frame_metadata* find_metadata() const noexcept {
+        return meta_slot == no_metadata ? nullptr : &frame_metadata_table::instance()[meta_slot];
+    }
+
+private:
+    void release_metadata() noexcept {
+        if (meta_slot != no_metadata) {
+            frame_metadata_table::instance().release(meta_slot);
+            meta_slot = no_metadata;
+        }
+    }
 };
 
 using hw_frame_ref = std::shared_ptr<hw_frame>;
 
+/// Base of the per-request state passed through the decoder's C-style callback.
+struct hw_decoder_client_data {
+};
+
 /// A mock HW decoder representing a legacy C-style API.
-struct hw_decoder
+/// `Context` provides the decoder's thread via `get_scheduler()`; it may be a reference to a shared context.
+/// When its scheduler supports `schedule_after` (e.g. `sim_context`), the decode latency is waited on
+/// the scheduler instead of sleeping the thread.
+template <class Context>
+struct basic_hw_decoder
 {
-    struct client_data_t {
-    };
+    using client_data_t = hw_decoder_client_data;
 
     template <class T>
     using callback_t = std::function<void(client_data_t*, T&& frame)>;
 
-    // simulate a HW decoder's async callback
+    // a failed decode, e.g. the payload could not be allocated
+    using error_callback_t = std::function<void(client_data_t*, std::exception_ptr error)>;
+
+    basic_hw_decoder() = default;
+
+    template <class... Args>
+    explicit basic_hw_decoder(std::in_place_t, Args&&... args) : ctx(std::forward<Args>(args)...) {}
+
+    // simulate a HW decoder's async callback; without `on_error_cb` a failed decode terminates
     template <class Frame>
-    void decode_next_frame(client_data_t* clientData, callback_t<Frame> on_frame_cb) {
+    void decode_next_frame(client_data_t* clientData, callback_t<Frame> on_frame_cb, error_callback_t on_error_cb = {}) {
+        metrics().in_flight.add();
+        auto requested = capture_time();
+        auto intended = intended_capture_time(requested);
+
         auto s1 =
-            ctx.get_scheduler().schedule()
+            schedule_decode(intended > requested ? intended - requested : frame_clock::duration {})
             | stdexec::then([=, this] {
                 // contrive some frame data
-                std::this_thread::sleep_for(std::chrono::milliseconds(5));
                 uint8_t offset = index*4;
 
                 // auto frame = std::make_shared<hw_frame>(index++, std::vector<int32_t>{ offset++, offset++, offset++, offset++});
-                auto frame = Frame { index++, std::vector<int32_t>{ offset++, offset++, offset++, offset++} };
+                auto payload = typename Frame::data_type({ offset++, offset++, offset++, offset++ }, frame_resource);
+                auto delivered = capture_time();
+                auto frame = Frame { index++, std::move(payload), frame_interval.count() ? intended : delivered };
+
+                auto& m = metrics();
+                m.decode_latency.observe(std::chrono::duration<double>(delivered - requested).count());
+                m.frames_decoded.add();
+                m.in_flight.sub();
 
                 // perform C-style callback
                 on_frame_cb(clientData, std::move(frame));
             })
+            | stdexec::upon_error([=](std::exception_ptr error) {
+                metrics().in_flight.sub(); // the frame was not delivered
+                if (!on_error_cb) std::rethrow_exception(error);
+                on_error_cb(clientData, error);
+            })
+            | stdexec::upon_stopped([] {
+                metrics().in_flight.sub(); // cancelled before the frame was decoded
+            })
             ;
 
-        scope.spawn(std::move(s1));
+        spawn_pooled(scope, std::move(s1));
     }
 
-    ~hw_decoder() {
+    /// Continue decoding at `frame_index`, e.g. when resuming from a checkpoint.
+    /// Only valid while no decode request is in flight.
+    void seek(int32_t frame_index) {
+        index = frame_index;
+        requested_.store(frame_index, std::memory_order_relaxed);
+    }
+
+    ~basic_hw_decoder() {
         stdexec::sync_wait(scope.on_empty());
     }
 
-    exec::single_thread_context ctx;
+    Context ctx;
     exec::async_scope scope;
     int32_t index {};
+    std::chrono::microseconds latency { 5000 }; // simulated decode time per frame
+    std::pmr::memory_resource* frame_resource = std::pmr::get_default_resource(); // frame payloads
+
+    /// Camera-like pacing, for open-loop load: when set, the i-th requested frame is captured at
+    /// `first_capture + i * frame_interval` and delivered `latency` after that, or after the request
+    /// if that comes later. `capture_time` is the intended capture time, so a consumer that falls
+    /// behind sees its delay grow instead of the source slowing down to match it.
+    /// `first_capture` defaults to the first request; it is read once, by the first paced request.
+    std::chrono::nanoseconds frame_interval {};
+    std::optional<frame_clock::time_point> first_capture;
+
+private:
+    static constexpr auto no_epoch = frame_clock::duration::min().count();
+
+    std::atomic<int32_t> requested_ {};     // frame slots handed out to requests; `index` counts deliveries
+    std::atomic<frame_clock::rep> epoch_ { no_epoch }; // capture time of slot 0, fixed by the first paced request
+
+    // shared by all decoders, in `metrics_registry::global()`
+    struct decoder_metrics {
+        metric_counter& frames_decoded;
+        metric_gauge& in_flight;
+        metric_histogram& decode_latency;
+    };
+
+    static decoder_metrics& metrics() {
+        static auto m = [] {
+            auto& registry = metrics_registry::global();
+            return decoder_metrics {
+                registry.counter("hw_decoder_frames_decoded_total", "Frames delivered by hw_decoder."),
+                registry.gauge("hw_decoder_decodes_in_flight", "Decode requests waiting for their frame."),
+                registry.histogram("hw_decoder_decode_latency_seconds", "Time from decode request to frame, in scheduler time.",
+                                   metric_histogram::exponential_bounds(1e-5, 2, 20)),
+            };
+        }();
+        return m;
+    }
+
+    // virtual time when the scheduler has a clock (e.g. `sim_context`)
+    frame_clock::time_point capture_time() {
+        auto sched = ctx.get_scheduler();
+        if constexpr (requires { std::chrono::duration_cast<frame_clock::duration>(sched.now()); }) {
+            return frame_clock::time_point(std::chrono::duration_cast<frame_clock::duration>(sched.now()));
+        } else {
+            return frame_clock::now();
+        }
+    }
+
+    // when the requested frame is due; `now` when not paced. The slot is reserved here, on the
+    // requesting thread, so requests in flight together get consecutive capture times. Requests
+    // may come from several threads: the first to find no epoch sets it, the others use the winner's.
+    frame_clock::time_point intended_capture_time(frame_clock::time_point now) {
+        auto slot = requested_.fetch_add(1, std::memory_order_relaxed);
+        if (!frame_interval.count()) return now;
+        auto offset = std::chrono::duration_cast<frame_clock::duration>(slot * frame_interval);
+
+        auto epoch = epoch_.load(std::memory_order_relaxed);
+        if (epoch == no_epoch) {
+            auto mine = (first_capture ? *first_capture : now - offset).time_since_epoch().count();
+            epoch = epoch_.compare_exchange_strong(epoch, mine, std::memory_order_relaxed) ? mine : epoch;
+        }
+        return frame_clock::time_point(frame_clock::duration(epoch)) + offset;
+    }
+
+    // the decode latency after `wait`ing for the frame to be captured
+    auto schedule_decode(frame_clock::duration wait) {
+        auto sched = ctx.get_scheduler();
+        auto delay = std::chrono::duration_cast<std::chrono::nanoseconds>(wait + latency);
+        if constexpr (requires { sched.schedule_after(delay); }) {
+            return sched.schedule_after(delay);
+        } else {
+            return sched.schedule()
+                | stdexec::then([delay] { std::this_thread::sleep_for(delay); });
+        }
+    }
 };
 
+// the decoder's thread only exists while frames are being decoded
+using hw_decoder = basic_hw_decoder<lazy_thread_context>;
+
 
 // Opstate that is the bridge between C++ senders and C-style callback.
-template <typename Frame, typename Receiver>
-struct decode_frame_op_state : hw_decoder::client_data_t {
+template <typename Frame, typename Decoder, typename Receiver>
+struct decode_frame_op_state : hw_decoder_client_data {
     using operation_state_concept = stdexec::operation_state_t;
 
     // C-style callback registered with hw_decoder
-    static void on_frame(hw_decoder::client_data_t* baseOp, Frame&& frame) {
+    static void on_frame(hw_decoder_client_data* baseOp, Frame&& frame) {
         auto op = static_cast<decode_frame_op_state*>(baseOp);
         stdexec::set_value(std::move(op->receiver), std::forward<Frame>(frame));
     }
+
+    static void on_error(hw_decoder_client_data* baseOp, std::exception_ptr error) {
+        auto op = static_cast<decode_frame_op_state*>(baseOp);
+        stdexec::set_error(std::move(op->receiver), std::move(error));
+    }
  
     void start() noexcept {
         // initiate async operation
-        decoder->decode_next_frame<Frame>(this, &on_frame);
+        decoder->template decode_next_frame<Frame>(this, &on_frame, &on_error);
     }
 
     Receiver receiver;
-    hw_decoder* decoder;
+    Decoder* decoder;
 };
 
-template <class Frame>
+template <class Frame, class Decoder = hw_decoder>
 struct frame_index_sender_t {
     using sender_concept = stdexec::sender_t;
 
@@ -94,18 +281,18 @@ struct frame_index_sender_t {
 
     template <stdexec::receiver_of<completion_signatures> Receiver>
     auto connect(Receiver&& __receiver) const {
-        return decode_frame_op_state<std::decay_t<Frame>, std::decay_t<Receiver>>
+        return decode_frame_op_state<std::decay_t<Frame>, Decoder, std::decay_t<Receiver>>
             {
                 .receiver = std::forward<Receiver>(__receiver),
                 .decoder = decoder
             };
     }
 
-    hw_decoder* decoder;
+    Decoder* decoder;
 };
 
 // factory suitable for use in `let_value`
-template <typename Frame>
-stdexec::sender auto async_decode_frame(hw_decoder* decoder) {
-    return frame_index_sender_t<Frame> { .decoder = decoder };
+template <typename Frame, typename Decoder>
+stdexec::sender auto async_decode_frame(Decoder* decoder) {
+    return frame_index_sender_t<Frame, Decoder> { .decoder = decoder };
 }
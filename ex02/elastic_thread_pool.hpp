@@ -0,0 +1,312 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <stdexec/execution.hpp>
+
+/// A thread pool whose worker count follows the load.
+///
+/// A supervisor thread watches the oldest queued operation; when it has waited longer than `grow_latency`
+/// and no worker is idle, another worker is started (up to `max_threads`). Workers above `min_threads`
+/// retire after `idle_timeout` without work. Workers and the supervisor are started on first use and
+/// let go once the pool has been idle for `idle_timeout`, so with `min_threads = 0` an idle pool costs no threads.
+class elastic_thread_pool {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct options {
+        std::size_t min_threads = 1;
+        std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+        std::chrono::microseconds grow_latency { 500 };
+        std::chrono::milliseconds idle_timeout { 1000 };
+    };
+
+    struct task_base {
+        void (*execute)(task_base*) noexcept;
+        task_base* next;
+        clock::time_point enqueued;
+    };
+
+    class scheduler;
+
+    template <class Receiver>
+    struct operation : task_base {
+        using operation_state_concept = stdexec::operation_state_t;
+
+        static void execute_impl(task_base* base) noexcept {
+            auto op = static_cast<operation*>(base);
+            if (stdexec::get_stop_token(stdexec::get_env(op->receiver)).stop_requested()) {
+                stdexec::set_stopped(std::move(op->receiver));
+            } else {
+                stdexec::set_value(std::move(op->receiver));
+            }
+        }
+
+        void start() noexcept {
+            this->execute = &execute_impl;
+            pool->enqueue(this);
+        }
+
+        Receiver receiver;
+        elastic_thread_pool* pool;
+    };
+
+    struct env {
+        template <class CPO>
+        scheduler query(stdexec::get_completion_scheduler_t<CPO>) const noexcept;
+
+        elastic_thread_pool* pool;
+    };
+
+    struct sender {
+        using sender_concept = stdexec::sender_t;
+
+        using completion_signatures = stdexec::completion_signatures<
+            stdexec::set_value_t(),
+            stdexec::set_stopped_t()>;
+
+        template <stdexec::receiver_of<completion_signatures> Receiver>
+        auto connect(Receiver&& receiver) const {
+            return operation<std::decay_t<Receiver>>
+                {
+                    {},
+                    std::forward<Receiver>(receiver),
+                    pool
+                };
+        }
+
+        env get_env() const noexcept {
+            return env { pool };
+        }
+
+        elastic_thread_pool* pool;
+    };
+
+    class scheduler {
+    public:
+        explicit scheduler(elastic_thread_pool* pool) noexcept : pool_(pool) {}
+
+        sender schedule() const noexcept {
+            return sender { pool_ };
+        }
+
+        bool operator==(const scheduler&) const noexcept = default;
+
+    private:
+        elastic_thread_pool* pool_;
+    };
+
+    elastic_thread_pool() : elastic_thread_pool(options {}) {}
+
+    explicit elastic_thread_pool(options opts) : opts_(opts) {
+        opts_.max_threads = std::max<std::size_t>(1, std::max(opts_.max_threads, opts_.min_threads));
+    }
+
+    ~elastic_thread_pool() {
+        auto lock = std::unique_lock(mutex_);
+        stopping_ = true;
+        work_available_.notify_all();
+        supervisor_wakeup_.notify_all();
+
+        // workers drain the queue before exiting
+        auto supervisor = std::move(supervisor_);
+        auto workers = std::move(workers_);
+        auto retired = std::move(retired_);
+        lock.unlock();
+
+        if (supervisor.joinable()) supervisor.join();
+        for (auto& [id, worker] : workers) worker.join();
+        for (auto& worker : retired) worker.join();
+    }
+
+    // non-copyable, non-movable: operations point back at the pool
+    elastic_thread_pool(const elastic_thread_pool&) = delete;
+    elastic_thread_pool& operator=(const elastic_thread_pool&) = delete;
+
+    scheduler get_scheduler() noexcept {
+        return scheduler(this);
+    }
+
+    /// Live workers, not counting the supervisor.
+    std::size_t thread_count() const {
+        auto lock = std::unique_lock(mutex_);
+        return thread_count_;
+    }
+
+    /// Workers started over the pool's lifetime.
+    std::size_t threads_started() const {
+        auto lock = std::unique_lock(mutex_);
+        return threads_started_;
+    }
+
+    const options& config() const noexcept {
+        return opts_;
+    }
+
+private:
+    void enqueue(task_base* task) {
+        auto lock = std::unique_lock(mutex_);
+
+        task->next = nullptr;
+        task->enqueued = clock::now();
+        auto was_empty = head_ == nullptr;
+        if (tail_) {
+            tail_->next = task;
+        } else {
+            head_ = task;
+        }
+        tail_ = task;
+
+        if (idle_count_ > 0) {
+            work_available_.notify_one();
+        } else if (!stopping_ && thread_count_ < std::max<std::size_t>(1, opts_.min_threads)) {
+            // below the floor (or nothing running yet): no need to wait for latency to build up
+            spawn_worker();
+        }
+
+        if (stopping_) {
+            work_available_.notify_one();
+        } else if (!can_grow()) {
+            // fixed size: nothing to supervise
+        } else if (!supervisor_running_) {
+            if (supervisor_.joinable()) supervisor_.join(); // it has exited; see supervise()
+            supervisor_running_ = true;
+            supervisor_ = std::thread([this] { supervise(); });
+        } else if (was_empty) {
+            supervisor_wakeup_.notify_one();
+        }
+    }
+
+    bool can_grow() const noexcept {
+        return opts_.max_threads > std::max<std::size_t>(1, opts_.min_threads);
+    }
+
+    task_base* dequeue() {
+        auto task = head_;
+        head_ = task->next;
+        if (!head_) tail_ = nullptr;
+        return task;
+    }
+
+    // call with mutex_ held
+    void spawn_worker() {
+        join_retired();
+
+        auto worker = std::thread([this] { work(); });
+        auto id = worker.get_id();
+        workers_.emplace(id, std::move(worker));
+        ++thread_count_;
+        ++threads_started_;
+    }
+
+    // call with mutex_ held; retired workers no longer touch the pool
+    void join_retired() {
+        for (auto& worker : retired_) worker.join();
+        retired_.clear();
+    }
+
+    void work() {
+        auto lock = std::unique_lock(mutex_);
+        for (;;) {
+            if (head_) {
+                auto task = dequeue();
+                lock.unlock();
+                task->execute(task);
+                lock.lock();
+                continue;
+            }
+
+            if (stopping_) break;
+
+            ++idle_count_;
+            auto woken = work_available_.wait_for(lock, opts_.idle_timeout, [this] { return head_ || stopping_; });
+            --idle_count_;
+
+            if (!woken && thread_count_ > opts_.min_threads) break;
+        }
+
+        --thread_count_;
+        if (!stopping_) {
+            auto self = workers_.find(std::this_thread::get_id());
+            retired_.push_back(std::move(self->second));
+            workers_.erase(self);
+        }
+    }
+
+    void supervise() {
+        auto lock = std::unique_lock(mutex_);
+        while (!stopping_) {
+            if (!head_) {
+                auto woken = supervisor_wakeup_.wait_for(lock, opts_.idle_timeout, [this] { return head_ || stopping_; });
+                if (!woken && thread_count_ == 0) {
+                    // the pool went fully idle; the next enqueue starts a new supervisor
+                    break;
+                }
+                continue;
+            }
+
+            auto waited = clock::now() - head_->enqueued;
+            if (waited >= opts_.grow_latency && idle_count_ == 0 && thread_count_ < opts_.max_threads) {
+                spawn_worker();
+            }
+
+            auto next_check = std::max<clock::duration>(opts_.grow_latency - waited, opts_.grow_latency / 4);
+            supervisor_wakeup_.wait_for(lock, next_check);
+        }
+        supervisor_running_ = false;
+    }
+
+    options opts_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable supervisor_wakeup_;
+    task_base* head_ {};
+    task_base* tail_ {};
+
+    std::thread supervisor_;
+    std::unordered_map<std::thread::id, std::thread> workers_;
+    std::vector<std::thread> retired_;
+    std::size_t thread_count_ {};
+    std::size_t idle_count_ {};
+    std::size_t threads_started_ {};
+    bool supervisor_running_ {};
+    bool stopping_ {};
+};
+
+template <class CPO>
+inline elastic_thread_pool::scheduler elastic_thread_pool::env::query(stdexec::get_completion_scheduler_t<CPO>) const noexcept {
+    return pool->get_scheduler();
+}
+
+/// A drop-in for `exec::single_thread_context` that starts its thread on the first `schedule()`
+/// and lets it go after `idle_timeout` without work; the next `schedule()` starts a new one.
+/// Work stays serialized, but unlike `single_thread_context` it may run on a different thread after an idle period.
+class lazy_thread_context {
+public:
+    explicit lazy_thread_context(std::chrono::milliseconds idle_timeout = std::chrono::milliseconds(1000))
+        : pool_(elastic_thread_pool::options {
+            .min_threads = 0,
+            .max_threads = 1,
+            .idle_timeout = idle_timeout,
+        }) {
+    }
+
+    elastic_thread_pool::scheduler get_scheduler() noexcept {
+        return pool_.get_scheduler();
+    }
+
+    /// 1 while the thread is running, 0 otherwise.
+    std::size_t thread_count() const {
+        return pool_.thread_count();
+    }
+
+private:
+    elastic_thread_pool pool_;
+};
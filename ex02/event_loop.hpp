@@ -0,0 +1,207 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <stdexec/execution.hpp>
+
+#include "wait_strategy.hpp"
+
+/// A drop-in replacement for `stdexec::run_loop` when many threads hop onto one consumer thread,
+/// e.g. `continues_on(main_sched)` for every processed frame.
+///
+/// `run_loop` takes a mutex and signals a condition variable on every enqueue. Here producers push
+/// operations onto an intrusive lock-free stack with one CAS; `run()` takes the whole stack with one
+/// exchange, reverses it to FIFO order and executes the batch. When the queue is empty the thread
+/// parks on an atomic wait (a futex on Linux), and a producer only pays for the wake-up system call
+/// when it finds the loop parked.
+///
+/// With a `wait_strategy` other than `park()`, an idle loop first spins and yields, which trades a
+/// core for a faster reaction to the next hop.
+///
+/// As with `run_loop`, `run()` returns once `finish()` has been called and the queue is empty, and
+/// the loop may be destroyed as soon as it has: `run()` also waits for producers still inside
+/// `enqueue()` or `finish()` (after publishing, while checking whether to wake the loop) to leave.
+class event_loop {
+public:
+    struct task_base {
+        void (*execute)(task_base*) noexcept;
+        task_base* next;
+    };
+
+    class scheduler;
+
+    template <class Receiver>
+    struct operation : task_base {
+        using operation_state_concept = stdexec::operation_state_t;
+
+        static void execute_impl(task_base* base) noexcept {
+            auto op = static_cast<operation*>(base);
+            if (stdexec::get_stop_token(stdexec::get_env(op->receiver)).stop_requested()) {
+                stdexec::set_stopped(std::move(op->receiver));
+            } else {
+                stdexec::set_value(std::move(op->receiver));
+            }
+        }
+
+        void start() noexcept {
+            this->execute = &execute_impl;
+            loop->enqueue(this);
+        }
+
+        Receiver receiver;
+        event_loop* loop;
+    };
+
+    struct env {
+        template <class CPO>
+        scheduler query(stdexec::get_completion_scheduler_t<CPO>) const noexcept;
+
+        event_loop* loop;
+    };
+
+    struct sender {
+        using sender_concept = stdexec::sender_t;
+
+        using completion_signatures = stdexec::completion_signatures<
+            stdexec::set_value_t(),
+            stdexec::set_stopped_t()>;
+
+        template <stdexec::receiver_of<completion_signatures> Receiver>
+        auto connect(Receiver&& receiver) const {
+            return operation<std::decay_t<Receiver>>
+                {
+                    {},
+                    std::forward<Receiver>(receiver),
+                    loop
+                };
+        }
+
+        env get_env() const noexcept {
+            return env { loop };
+        }
+
+        event_loop* loop;
+    };
+
+    class scheduler {
+    public:
+        explicit scheduler(event_loop* loop) noexcept : loop_(loop) {}
+
+        sender schedule() const noexcept {
+            return sender { loop_ };
+        }
+
+        bool operator==(const scheduler&) const noexcept = default;
+
+    private:
+        event_loop* loop_;
+    };
+
+    explicit event_loop(wait_strategy wait = {}) noexcept : wait_(wait) {}
+
+    // non-copyable, non-movable: operations point back at the loop
+    event_loop(const event_loop&) = delete;
+    event_loop& operator=(const event_loop&) = delete;
+
+    scheduler get_scheduler() noexcept {
+        return scheduler(this);
+    }
+
+    /// Execute operations on the calling thread until `finish()` is called and none are left.
+    void run() {
+        for (;;) {
+            auto batch = head_.exchange(nullptr, std::memory_order_acquire);
+            if (!batch) {
+                if (finishing_.load(std::memory_order_acquire)) {
+                    wait_for_producers();
+                    return;
+                }
+                auto ready = wait_.poll([this] {
+                    return head_.load(std::memory_order_relaxed) || finishing_.load(std::memory_order_relaxed);
+                });
+                if (!ready) park();
+                continue;
+            }
+
+            // pushed newest first
+            task_base* fifo = nullptr;
+            while (batch) {
+                auto next = batch->next;
+                batch->next = fifo;
+                fifo = batch;
+                batch = next;
+            }
+            ++batches_;
+            while (fifo) {
+                auto next = fifo->next; // `execute` may destroy the operation
+                fifo->execute(fifo);
+                fifo = next;
+            }
+        }
+    }
+
+    /// Make `run()` return once the queue is empty. May be called from any thread.
+    void finish() noexcept {
+        producers_.fetch_add(1, std::memory_order_seq_cst);
+        finishing_.store(true, std::memory_order_seq_cst);
+        wake();
+        producers_.fetch_sub(1, std::memory_order_release); // last access to the loop
+    }
+
+    /// Batches executed by `run()` so far; with the operations executed, the average batch size.
+    std::size_t batches() const noexcept {
+        return batches_;
+    }
+
+private:
+    enum : uint32_t { running, parked };
+
+    // Once the task is pushed, the loop may run it, finish and be destroyed while this thread is
+    // still in `wake()`; `producers_` keeps `run()` from returning until it is out.
+    void enqueue(task_base* task) noexcept {
+        producers_.fetch_add(1, std::memory_order_seq_cst);
+        task->next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(task->next, task, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        }
+        wake();
+        producers_.fetch_sub(1, std::memory_order_release); // last access to the loop
+    }
+
+    // only a few instructions to wait out; a notification would touch the loop again
+    void wait_for_producers() const noexcept {
+        while (producers_.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Producers push, then check `state_`; the loop sets `state_`, then checks the queue. Both
+    // sides are sequentially consistent, so one of them sees the other and no wake-up is lost.
+    void wake() noexcept {
+        if (state_.load(std::memory_order_seq_cst) == parked
+            && state_.exchange(running, std::memory_order_seq_cst) == parked) {
+            state_.notify_one();
+        }
+    }
+
+    void park() noexcept {
+        state_.store(parked, std::memory_order_seq_cst);
+        if (!head_.load(std::memory_order_seq_cst) && !finishing_.load(std::memory_order_seq_cst)) {
+            state_.wait(parked, std::memory_order_acquire);
+        }
+        state_.store(running, std::memory_order_relaxed);
+    }
+
+    alignas(64) std::atomic<task_base*> head_ { nullptr };
+    alignas(64) std::atomic<uint32_t> state_ { running };
+    std::atomic<bool> finishing_ { false };
+    std::atomic<uint32_t> producers_ { 0 };   // threads inside `enqueue()` or `finish()`
+    wait_strategy wait_;
+    std::size_t batches_ {};
+};
+
+template <class CPO>
+inline event_loop::scheduler event_loop::env::query(stdexec::get_completion_scheduler_t<CPO>) const noexcept {
+    return loop->get_scheduler();
+}
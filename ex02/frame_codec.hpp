@@ -0,0 +1,399 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "frame_header.hpp"
+
+/// Pluggable compression for frame payloads (`hw_frame::data`), e.g. for frames buffered in caches
+/// or sent over `frame_socket_server`.
+class frame_codec {
+public:
+    virtual ~frame_codec() = default;
+
+    virtual std::string_view name() const noexcept = 0;
+
+    /// Upper bound of `encode`'s output for `count` values.
+    virtual std::size_t max_encoded_size(std::size_t count) const noexcept = 0;
+
+    /// Encode `values` into `out`, which must hold `max_encoded_size(values.size())` bytes.
+    /// Returns the number of bytes written.
+    virtual std::size_t encode(std::span<const int32_t> values, std::span<std::byte> out) const = 0;
+
+    /// Decode exactly `out.size()` values from `in`.
+    virtual void decode(std::span<const std::byte> in, std::span<int32_t> out) const = 0;
+};
+
+/// No compression; the baseline for benchmarks.
+class raw_codec final : public frame_codec {
+public:
+    std::string_view name() const noexcept override {
+        return "raw";
+    }
+
+    std::size_t max_encoded_size(std::size_t count) const noexcept override {
+        return count * sizeof(int32_t);
+    }
+
+    std::size_t encode(std::span<const int32_t> values, std::span<std::byte> out) const override {
+        std::memcpy(out.data(), values.data(), values.size_bytes());
+        return values.size_bytes();
+    }
+
+    void decode(std::span<const std::byte> in, std::span<int32_t> out) const override {
+        if (in.size() < out.size_bytes()) {
+            throw std::runtime_error("raw_codec: truncated input");
+        }
+        std::memcpy(out.data(), in.data(), out.size_bytes());
+    }
+};
+
+/// Delta + zig-zag + bit-packing for integer frame data.
+///
+/// Values are replaced by the difference to their predecessor, zig-zag mapped so small negative
+/// differences become small unsigned numbers, and packed in blocks of 128 with the bit width of the
+/// block's largest value. Smooth or slowly changing data (image rows, counters, sensor values) shrinks
+/// to a few bits per value; random data costs one byte per block over raw.
+///
+/// Delta and zig-zag run four lanes at a time with SSE2 or NEON where available. Packing goes 8
+/// values at a time (a group of 8 is exactly `bits` bytes): with SIMD for widths up to 16, as a copy
+/// for width 32, and byte by byte otherwise and for the last values of a block.
+class delta_zigzag_codec final : public frame_codec {
+public:
+    static constexpr std::size_t block_size = 128;
+
+    std::string_view name() const noexcept override {
+        return "delta_zigzag";
+    }
+
+    std::size_t max_encoded_size(std::size_t count) const noexcept override {
+        auto blocks = (count + block_size - 1) / block_size;
+        // one width byte per block, at most 32 bits per value; packing writes whole bytes only
+        return blocks + count * sizeof(int32_t);
+    }
+
+    std::size_t encode(std::span<const int32_t> values, std::span<std::byte> out) const override {
+        uint32_t zigzag[block_size];
+        auto dst = reinterpret_cast<uint8_t*>(out.data());
+        auto prev = int32_t {};
+
+        for (std::size_t begin = 0; begin < values.size(); begin += block_size) {
+            auto n = std::min(block_size, values.size() - begin);
+            auto bits = delta_zigzag(values.data() + begin, n, prev, zigzag);
+            prev = values[begin + n - 1];
+
+            *dst++ = static_cast<uint8_t>(bits);
+            dst = pack(zigzag, n, bits, dst);
+        }
+
+        return static_cast<std::size_t>(dst - reinterpret_cast<uint8_t*>(out.data()));
+    }
+
+    void decode(std::span<const std::byte> in, std::span<int32_t> out) const override {
+        auto src = reinterpret_cast<const uint8_t*>(in.data());
+        auto end = src + in.size();
+        auto prev = int32_t {};
+
+        for (std::size_t begin = 0; begin < out.size(); begin += block_size) {
+            auto n = std::min(block_size, out.size() - begin);
+            if (src == end) {
+                throw std::runtime_error("delta_zigzag_codec: truncated input");
+            }
+
+            auto bits = *src++;
+            auto packed_bytes = (n * bits + 7) / 8;
+            if (bits > 32 || static_cast<std::size_t>(end - src) < packed_bytes) {
+                throw std::runtime_error("delta_zigzag_codec: corrupt input");
+            }
+
+            auto dst = out.data() + begin;
+            unpack(src, n, bits, reinterpret_cast<uint32_t*>(dst));
+            src += packed_bytes;
+            prev = undelta_zigzag(dst, n, prev);
+        }
+    }
+
+private:
+    // zig-zag encoded deltas of `values` into `out`; returns the bit width of the largest one
+    static unsigned delta_zigzag(const int32_t* values, std::size_t n, int32_t prev, uint32_t* out) {
+        uint32_t any = 0;
+        std::size_t i = 0;
+
+#if defined(__SSE2__)
+        auto acc = _mm_setzero_si128();
+        if (n >= 4) {
+            // first vector: the predecessor of lane 0 comes from the previous block
+            auto cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+            auto before = _mm_set_epi32(values[2], values[1], values[0], prev);
+            auto delta = _mm_sub_epi32(cur, before);
+            auto zz = _mm_xor_si128(_mm_slli_epi32(delta, 1), _mm_srai_epi32(delta, 31));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), zz);
+            acc = _mm_or_si128(acc, zz);
+            i = 4;
+        }
+        for (; i + 4 <= n; i += 4) {
+            auto cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            auto before = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i - 1));
+            auto delta = _mm_sub_epi32(cur, before);
+            auto zz = _mm_xor_si128(_mm_slli_epi32(delta, 1), _mm_srai_epi32(delta, 31));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), zz);
+            acc = _mm_or_si128(acc, zz);
+        }
+        uint32_t lanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        any = lanes[0] | lanes[1] | lanes[2] | lanes[3];
+#elif defined(__ARM_NEON)
+        auto acc = vdupq_n_u32(0);
+        if (n >= 4) {
+            int32_t first[4] = { prev, values[0], values[1], values[2] };
+            auto delta = vsubq_s32(vld1q_s32(values), vld1q_s32(first));
+            auto zz = veorq_u32(vreinterpretq_u32_s32(vshlq_n_s32(delta, 1)), vreinterpretq_u32_s32(vshrq_n_s32(delta, 31)));
+            vst1q_u32(out, zz);
+            acc = vorrq_u32(acc, zz);
+            i = 4;
+        }
+        for (; i + 4 <= n; i += 4) {
+            auto delta = vsubq_s32(vld1q_s32(values + i), vld1q_s32(values + i - 1));
+            auto zz = veorq_u32(vreinterpretq_u32_s32(vshlq_n_s32(delta, 1)), vreinterpretq_u32_s32(vshrq_n_s32(delta, 31)));
+            vst1q_u32(out + i, zz);
+            acc = vorrq_u32(acc, zz);
+        }
+        any = vgetq_lane_u32(acc, 0) | vgetq_lane_u32(acc, 1) | vgetq_lane_u32(acc, 2) | vgetq_lane_u32(acc, 3);
+#endif
+
+        for (; i < n; ++i) {
+            auto before = i ? values[i - 1] : prev;
+            auto delta = static_cast<uint32_t>(values[i]) - static_cast<uint32_t>(before);
+            auto zz = (delta << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(delta) >> 31);
+            out[i] = zz;
+            any |= zz;
+        }
+
+        return static_cast<unsigned>(std::bit_width(any));
+    }
+
+    // inverse of delta_zigzag, in place; returns the last value
+    static int32_t undelta_zigzag(int32_t* values, std::size_t n, int32_t prev) {
+        auto zz = reinterpret_cast<uint32_t*>(values);
+        std::size_t i = 0;
+
+#if defined(__SSE2__)
+        auto one = _mm_set1_epi32(1);
+        for (; i + 4 <= n; i += 4) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(zz + i));
+            auto delta = _mm_xor_si128(_mm_srli_epi32(v, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(v, one)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(zz + i), delta);
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 4 <= n; i += 4) {
+            auto v = vld1q_u32(zz + i);
+            auto delta = veorq_u32(vshrq_n_u32(v, 1), vreinterpretq_u32_s32(vnegq_s32(vreinterpretq_s32_u32(vandq_u32(v, vdupq_n_u32(1))))));
+            vst1q_u32(zz + i, delta);
+        }
+#endif
+        for (; i < n; ++i) {
+            zz[i] = (zz[i] >> 1) ^ (0u - (zz[i] & 1u));
+        }
+
+        // prefix sum of the deltas
+        auto running = static_cast<uint32_t>(prev);
+        for (i = 0; i < n; ++i) {
+            running += zz[i];
+            zz[i] = running;
+        }
+        return static_cast<int32_t>(running);
+    }
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    static constexpr bool simd_groups = std::endian::native == std::endian::little;
+#else
+    static constexpr bool simd_groups = false;
+#endif
+
+    static uint8_t* pack(const uint32_t* values, std::size_t n, unsigned bits, uint8_t* dst) {
+        if (bits == 0) return dst;
+        if (bits == 32 && std::endian::native == std::endian::little) {
+            std::memcpy(dst, values, n * sizeof(uint32_t));
+            return dst + n * sizeof(uint32_t);
+        }
+
+        std::size_t i = 0;
+        if constexpr (simd_groups) {
+            if (bits <= 16) {
+                for (; i + 8 <= n; i += 8) dst = pack_group(values + i, bits, dst);
+            }
+        }
+
+        // groups are whole bytes, so the rest starts on a byte boundary
+        uint64_t acc = 0;
+        unsigned filled = 0;
+        for (; i < n; ++i) {
+            acc |= static_cast<uint64_t>(values[i]) << filled;
+            filled += bits;
+            while (filled >= 8) {
+                *dst++ = static_cast<uint8_t>(acc);
+                acc >>= 8;
+                filled -= 8;
+            }
+        }
+        if (filled > 0) {
+            *dst++ = static_cast<uint8_t>(acc);
+        }
+        return dst;
+    }
+
+    static void unpack(const uint8_t* src, std::size_t n, unsigned bits, uint32_t* out) {
+        if (bits == 0) {
+            std::fill_n(out, n, 0u);
+            return;
+        }
+        if (bits == 32 && std::endian::native == std::endian::little) {
+            std::memcpy(out, src, n * sizeof(uint32_t));
+            return;
+        }
+
+        std::size_t i = 0;
+        if constexpr (simd_groups) {
+            if (bits <= 16) {
+                for (; i + 8 <= n; i += 8, src += bits) unpack_group(src, bits, out + i);
+            }
+        }
+
+        const auto mask = bits == 32 ? ~uint64_t(0) >> 32 : (uint64_t(1) << bits) - 1;
+        uint64_t acc = 0;
+        unsigned available = 0;
+        for (; i < n; ++i) {
+            while (available < bits) {
+                acc |= static_cast<uint64_t>(*src++) << available;
+                available += 8;
+            }
+            out[i] = static_cast<uint32_t>(acc & mask);
+            acc >>= bits;
+            available -= bits;
+        }
+    }
+
+    // A group of 8 values of up to 16 bits is combined in 64-bit lanes: neighbours into pairs
+    // (2 * bits), pairs into the group's two halves (4 * bits each), which are joined and stored
+    // as `bits` bytes. Unpacking splits the same way back. All shifts are uniform across lanes.
+
+    static uint8_t* pack_group(const uint32_t* values, unsigned bits, uint8_t* dst) {
+        uint64_t halves[2];
+#if defined(__SSE2__)
+        auto low = _mm_set_epi32(0, -1, 0, -1);
+        auto shift = _mm_cvtsi32_si128(static_cast<int>(bits));
+        auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+        auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + 4));
+        auto pairs_a = _mm_or_si128(_mm_and_si128(a, low), _mm_sll_epi64(_mm_srli_epi64(a, 32), shift));
+        auto pairs_b = _mm_or_si128(_mm_and_si128(b, low), _mm_sll_epi64(_mm_srli_epi64(b, 32), shift));
+        auto half = _mm_or_si128(_mm_unpacklo_epi64(pairs_a, pairs_b),
+                                 _mm_sll_epi64(_mm_unpackhi_epi64(pairs_a, pairs_b), _mm_cvtsi32_si128(static_cast<int>(2 * bits))));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(halves), half);
+#elif defined(__ARM_NEON)
+        auto low = vdupq_n_u64(0xffffffff);
+        auto shift = vdupq_n_s64(bits);
+        auto a = vreinterpretq_u64_u32(vld1q_u32(values));
+        auto b = vreinterpretq_u64_u32(vld1q_u32(values + 4));
+        auto pairs_a = vorrq_u64(vandq_u64(a, low), vshlq_u64(vshrq_n_u64(a, 32), shift));
+        auto pairs_b = vorrq_u64(vandq_u64(b, low), vshlq_u64(vshrq_n_u64(b, 32), shift));
+        auto half = vorrq_u64(vcombine_u64(vget_low_u64(pairs_a), vget_low_u64(pairs_b)),
+                              vshlq_u64(vcombine_u64(vget_high_u64(pairs_a), vget_high_u64(pairs_b)), vdupq_n_s64(2 * bits)));
+        vst1q_u64(halves, half);
+#else
+        (void)values;
+        halves[0] = halves[1] = 0;
+#endif
+        auto half_bits = 4 * bits;
+        uint64_t words[2] = { halves[0], halves[1] };
+        if (half_bits < 64) {
+            words[0] = halves[0] | halves[1] << half_bits;
+            words[1] = halves[1] >> (64 - half_bits);
+        }
+        std::memcpy(dst, words, bits);
+        return dst + bits;
+    }
+
+    static void unpack_group(const uint8_t* src, unsigned bits, uint32_t* out) {
+        uint64_t words[2] = {};
+        std::memcpy(words, src, bits);
+
+        auto half_bits = 4 * bits;
+        auto halves_lo = words[0];
+        auto halves_hi = words[1];
+        if (half_bits < 64) {
+            auto mask = (uint64_t(1) << half_bits) - 1;
+            halves_lo = words[0] & mask;
+            halves_hi = (words[0] >> half_bits | words[1] << (64 - half_bits)) & mask;
+        }
+
+        auto value_mask = (uint64_t(1) << bits) - 1;
+        auto pair_mask = (uint64_t(1) << (2 * bits)) - 1;
+#if defined(__SSE2__)
+        auto half = _mm_set_epi64x(static_cast<int64_t>(halves_hi), static_cast<int64_t>(halves_lo));
+        auto shift = _mm_cvtsi32_si128(static_cast<int>(bits));
+        auto vmask = _mm_set1_epi64x(static_cast<int64_t>(value_mask));
+        auto even_pairs = _mm_and_si128(half, _mm_set1_epi64x(static_cast<int64_t>(pair_mask)));
+        auto odd_pairs = _mm_srl_epi64(half, _mm_cvtsi32_si128(static_cast<int>(2 * bits)));
+        auto split = [&](__m128i pairs) {
+            return _mm_or_si128(_mm_and_si128(pairs, vmask), _mm_slli_epi64(_mm_and_si128(_mm_srl_epi64(pairs, shift), vmask), 32));
+        };
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), split(_mm_unpacklo_epi64(even_pairs, odd_pairs)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), split(_mm_unpackhi_epi64(even_pairs, odd_pairs)));
+#elif defined(__ARM_NEON)
+        auto half = vcombine_u64(vcreate_u64(halves_lo), vcreate_u64(halves_hi));
+        auto shift = vdupq_n_s64(-static_cast<int64_t>(bits));
+        auto vmask = vdupq_n_u64(value_mask);
+        auto even_pairs = vandq_u64(half, vdupq_n_u64(pair_mask));
+        auto odd_pairs = vshlq_u64(half, vdupq_n_s64(-2 * static_cast<int64_t>(bits)));
+        auto split = [&](uint64x2_t pairs) {
+            return vorrq_u64(vandq_u64(pairs, vmask), vshlq_n_u64(vandq_u64(vshlq_u64(pairs, shift), vmask), 32));
+        };
+        vst1q_u32(out, vreinterpretq_u32_u64(split(vcombine_u64(vget_low_u64(even_pairs), vget_low_u64(odd_pairs)))));
+        vst1q_u32(out + 4, vreinterpretq_u32_u64(split(vcombine_u64(vget_high_u64(even_pairs), vget_high_u64(odd_pairs)))));
+#else
+        (void)out;
+        (void)value_mask;
+        (void)pair_mask;
+#endif
+    }
+};
+
+/// A frame payload held in compressed form, e.g. while it waits in a cache or queue.
+/// Metadata attached to the frame is not kept.
+struct compressed_frame {
+    frame_header header;
+    uint32_t count {};
+    std::vector<std::byte> bytes;
+
+    template <typename Frame>
+    static compressed_frame compress(const Frame& frame, const frame_codec& codec) {
+        auto result = compressed_frame { frame.detached(), static_cast<uint32_t>(frame.data.size()), {} };
+        result.bytes.resize(codec.max_encoded_size(frame.data.size()));
+        result.bytes.resize(codec.encode(frame.data, result.bytes));
+        return result;
+    }
+
+    /// The payload is allocated from `resource`.
+    template <typename Frame>
+    Frame decompress(const frame_codec& codec,
+                     std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const {
+        auto data = typename Frame::data_type(count, resource);
+        codec.decode(bytes, data);
+        return Frame { header, std::move(data) };
+    }
+};
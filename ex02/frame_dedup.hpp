@@ -0,0 +1,127 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+
+#include "sequence_view.hpp"
+
+/// 64-bit hash of a frame payload.
+///
+/// The XXH64 construction: four independent 64-bit accumulators consume 32-byte stripes, so the
+/// inner loop has no cross-lane dependency and keeps four multipliers busy (or one vector unit,
+/// where the compiler can use 64-bit vector multiplies). Roughly memory bandwidth on large frames.
+inline uint64_t frame_hash64(std::span<const std::byte> bytes, uint64_t seed = 0) noexcept {
+    constexpr uint64_t p1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t p2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t p3 = 0x165667B19E3779F9ull;
+    constexpr uint64_t p4 = 0x85EBCA77C2B2AE63ull;
+    constexpr uint64_t p5 = 0x27D4EB2F165667C5ull;
+
+    auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+    auto round = [&](uint64_t acc, uint64_t input) { return rotl(acc + input * p2, 31) * p1; };
+    auto merge = [&](uint64_t h, uint64_t acc) { return (h ^ round(0, acc)) * p1 + p4; };
+    auto load64 = [](const std::byte* p) { uint64_t v; std::memcpy(&v, p, 8); return v; };
+    auto load32 = [](const std::byte* p) { uint32_t v; std::memcpy(&v, p, 4); return uint64_t(v); };
+
+    auto p = bytes.data();
+    auto end = p + bytes.size();
+    uint64_t h;
+
+    if (bytes.size() >= 32) {
+        uint64_t lanes[4] = { seed + p1 + p2, seed + p2, seed, seed - p1 };
+        for (; end - p >= 32; p += 32) {
+            for (int lane = 0; lane < 4; ++lane) {
+                lanes[lane] = round(lanes[lane], load64(p + lane * 8));
+            }
+        }
+        h = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+        for (auto lane : lanes) h = merge(h, lane);
+    } else {
+        h = seed + p5;
+    }
+
+    h += bytes.size();
+
+    for (; end - p >= 8; p += 8) {
+        h = rotl(h ^ round(0, load64(p)), 27) * p1 + p4;
+    }
+    if (end - p >= 4) {
+        h = rotl(h ^ (load32(p) * p1), 23) * p2 + p3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h = rotl(h ^ (std::to_integer<uint64_t>(*p) * p5), 11) * p1;
+    }
+
+    h ^= h >> 33;
+    h *= p2;
+    h ^= h >> 29;
+    h *= p3;
+    h ^= h >> 32;
+    return h;
+}
+
+template <typename Frame>
+uint64_t frame_hash64(const Frame& frame) noexcept {
+    return frame_hash64(std::as_bytes(std::span(frame.data)));
+}
+
+/// An item of a deduplicated frame sequence: either a frame, or a repeat marker standing in for a
+/// frame whose payload equals that of the last frame passed on.
+template <typename Frame>
+struct dedup_item {
+    int32_t index {};               // index of this frame
+    int32_t repeat_of {};           // index of the frame with the same payload (== index if not a repeat)
+    uint64_t hash {};
+    std::optional<Frame> frame;     // empty for a repeat
+
+    bool is_repeat() const noexcept {
+        return !frame;
+    }
+};
+
+struct dedup_stats {
+    std::size_t frames {};
+    std::size_t repeats {};
+};
+
+/// Replaces consecutive frames with identical payloads by repeat markers, so downstream stages can
+/// skip re-processing (or re-sending) static content. Equality is decided by `frame_hash64` alone;
+/// a 64-bit collision between two consecutive frames is possible but vanishingly unlikely.
+///
+///     exec::iterate(make_frame_sequence(decoder) | dedup())
+///         | exec::transform_each(stdexec::then([](dedup_item<hw_frame>&& item) { ... }))
+///
+/// A repeat's frame is dropped at this point; its buffer is released immediately.
+inline auto dedup(dedup_stats* stats = nullptr) {
+    return sequence_adaptor { [stats]<typename Range>(Range range) {
+        using frame_t = std::ranges::range_value_t<Range>;
+
+        return make_pull_view<dedup_item<frame_t>>(
+            [upstream = upstream_cursor<Range>(std::move(range)),
+             last_hash = std::optional<uint64_t>(),
+             last_index = int32_t {},
+             stats]() mutable -> std::optional<dedup_item<frame_t>> {
+                auto frame = upstream.next();
+                if (!frame) {
+                    return std::nullopt;
+                }
+
+                auto hash = frame_hash64(*frame);
+                if (stats) ++stats->frames;
+
+                if (last_hash == hash) {
+                    if (stats) ++stats->repeats;
+                    return dedup_item<frame_t> { frame->index, last_index, hash, std::nullopt };
+                }
+
+                last_hash = hash;
+                last_index = frame->index;
+                return dedup_item<frame_t> { frame->index, frame->index, hash, std::move(frame) };
+            });
+    } };
+}
@@ -0,0 +1,169 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "sequence_view.hpp"
+
+/// Which tiles of a frame changed since the previous one. A tile is `tile_size` consecutive
+/// values of `hw_frame::data`; bit `i` of the bitmap is set if tile `i` changed.
+struct tile_mask {
+    std::size_t tile_size {};
+    std::size_t tile_count {};
+    std::vector<uint64_t> bits;
+
+    tile_mask() = default;
+
+    tile_mask(std::size_t tile_size, std::size_t tile_count)
+        : tile_size(tile_size), tile_count(tile_count), bits((tile_count + 63) / 64) {
+    }
+
+    bool changed(std::size_t tile) const noexcept {
+        return (bits[tile / 64] >> (tile % 64)) & 1;
+    }
+
+    void set(std::size_t tile) noexcept {
+        bits[tile / 64] |= uint64_t(1) << (tile % 64);
+    }
+
+    void set_all() noexcept {
+        std::fill(bits.begin(), bits.end(), ~uint64_t(0));
+        if (tile_count % 64) {
+            bits.back() = (uint64_t(1) << (tile_count % 64)) - 1;
+        }
+    }
+
+    std::size_t changed_count() const noexcept {
+        std::size_t count = 0;
+        for (auto word : bits) count += static_cast<std::size_t>(std::popcount(word));
+        return count;
+    }
+
+    /// Call `fn(first_value, value_count)` for every changed tile, in order.
+    template <typename Fn>
+    void for_each_changed(std::size_t value_count, Fn&& fn) const {
+        for (std::size_t w = 0; w < bits.size(); ++w) {
+            for (auto word = bits[w]; word; word &= word - 1) {
+                auto tile = w * 64 + static_cast<std::size_t>(std::countr_zero(word));
+                auto first = tile * tile_size;
+                fn(first, std::min(tile_size, value_count - first));
+            }
+        }
+    }
+};
+
+namespace detail {
+
+// true if the `n` values at `a` and `b` differ
+inline bool tile_differs(const int32_t* a, const int32_t* b, std::size_t n) noexcept {
+    std::size_t i = 0;
+    uint32_t any = 0;
+
+#if defined(__SSE2__)
+    auto acc = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        auto x0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        auto x1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 4)),
+                                _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 4)));
+        acc = _mm_or_si128(acc, _mm_or_si128(x0, x1));
+    }
+    any = _mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xffff;
+#elif defined(__ARM_NEON)
+    auto acc = vdupq_n_u32(0);
+    for (; i + 8 <= n; i += 8) {
+        auto x0 = veorq_u32(vld1q_u32(reinterpret_cast<const uint32_t*>(a + i)), vld1q_u32(reinterpret_cast<const uint32_t*>(b + i)));
+        auto x1 = veorq_u32(vld1q_u32(reinterpret_cast<const uint32_t*>(a + i + 4)), vld1q_u32(reinterpret_cast<const uint32_t*>(b + i + 4)));
+        acc = vorrq_u32(acc, vorrq_u32(x0, x1));
+    }
+    any = vgetq_lane_u32(acc, 0) | vgetq_lane_u32(acc, 1) | vgetq_lane_u32(acc, 2) | vgetq_lane_u32(acc, 3);
+#endif
+
+    for (; i < n; ++i) {
+        any |= static_cast<uint32_t>(a[i] ^ b[i]);
+    }
+    return any != 0;
+}
+
+} // namespace detail
+
+/// Compare `cur` against `prev` tile by tile and set the changed tiles in `mask`, which must be sized
+/// for `cur`. Frames of different sizes are entirely changed. Returns the number of changed tiles.
+inline std::size_t diff(std::span<const int32_t> prev, std::span<const int32_t> cur, tile_mask& mask) noexcept {
+    if (prev.size() != cur.size()) {
+        mask.set_all();
+        return mask.tile_count;
+    }
+
+    std::size_t changed = 0;
+    for (std::size_t tile = 0; tile < mask.tile_count; ++tile) {
+        auto first = tile * mask.tile_size;
+        auto n = std::min(mask.tile_size, cur.size() - first);
+        if (detail::tile_differs(prev.data() + first, cur.data() + first, n)) {
+            mask.set(tile);
+            ++changed;
+        }
+    }
+    return changed;
+}
+
+template <typename Frame>
+struct diff_item {
+    Frame frame;
+    tile_mask changed;  // all tiles for the first frame
+};
+
+/// Pairs every frame with the tiles that changed since the previous frame, so downstream stages
+/// can skip unchanged regions:
+///
+///     exec::iterate(make_frame_sequence(decoder) | diff_tiles(1024))
+///
+/// The previous payload is kept in one buffer owned by the adaptor, allocated on the first frame
+/// and reused after that; only changed tiles are copied into it.
+inline auto diff_tiles(std::size_t tile_size) {
+    tile_size = std::max<std::size_t>(1, tile_size);
+
+    return sequence_adaptor { [tile_size]<typename Range>(Range range) {
+        using frame_t = std::ranges::range_value_t<Range>;
+
+        return make_pull_view<diff_item<frame_t>>(
+            [upstream = upstream_cursor<Range>(std::move(range)),
+             previous = std::vector<int32_t>(),
+             first = true,
+             tile_size]() mutable -> std::optional<diff_item<frame_t>> {
+                auto frame = upstream.next();
+                if (!frame) {
+                    return std::nullopt;
+                }
+
+                auto cur = std::span<const int32_t>(frame->data);
+                auto mask = tile_mask(tile_size, (cur.size() + tile_size - 1) / tile_size);
+
+                if (first || previous.size() != cur.size()) {
+                    mask.set_all();
+                    previous.assign(cur.begin(), cur.end());
+                    first = false;
+                } else {
+                    diff(previous, cur, mask);
+                    mask.for_each_changed(cur.size(), [&](std::size_t offset, std::size_t count) {
+                        std::memcpy(previous.data() + offset, cur.data() + offset, count * sizeof(int32_t));
+                    });
+                }
+
+                return diff_item<frame_t> { std::move(*frame), std::move(mask) };
+            });
+    } };
+}
@@ -0,0 +1,176 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+/// Clock of frame capture timestamps; steady_clock is system-wide, so it compares across processes on one host.
+using frame_clock = std::chrono::steady_clock;
+
+enum frame_flags : uint32_t {
+    frame_flag_keyframe = 1u << 0,
+    frame_flag_discontinuity = 1u << 1,     // frames were lost or skipped before this one
+    frame_flag_corrupt = 1u << 2,
+};
+
+/// The fixed-size part of every frame, kept apart from the payload.
+///
+/// Hot loops touch only this header and the payload pointer; anything optional (deadlines, checksums,
+/// ...) lives in `frame_metadata_table`, referenced by `meta_slot`. Transports do not copy it as is:
+/// `time_point`'s representation is up to the implementation, so they send a `frame_header_record`.
+struct frame_header {
+    static constexpr uint32_t no_metadata = ~uint32_t(0);
+
+    int32_t index {};
+    uint32_t flags {};                          // frame_flags
+    frame_clock::time_point capture_time {};
+    uint32_t meta_slot = no_metadata;           // process-local
+    uint32_t reserved {};
+
+    bool has(frame_flags flag) const noexcept {
+        return (flags & flag) != 0;
+    }
+
+    /// A copy without the process-local metadata reference, e.g. for sending it elsewhere.
+    frame_header detached() const noexcept {
+        auto copy = *this;
+        copy.meta_slot = no_metadata;
+        return copy;
+    }
+};
+
+static_assert(std::is_standard_layout_v<frame_header> && std::is_trivially_copyable_v<frame_header>);
+
+/// `frame_header` as it is stored in shared memory or sent over a socket: fixed-width fields, with
+/// the capture time as nanoseconds since the `frame_clock` epoch. That epoch is the host's boot, so
+/// capture times compare between processes on one host but not across hosts. Metadata is not included.
+struct frame_header_record {
+    int32_t index {};
+    uint32_t flags {};
+    int64_t capture_ns {};
+
+    static frame_header_record from(const frame_header& header) noexcept {
+        return {
+            .index = header.index,
+            .flags = header.flags,
+            .capture_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(header.capture_time.time_since_epoch()).count(),
+        };
+    }
+
+    frame_header to_header() const noexcept {
+        return {
+            .index = index,
+            .flags = flags,
+            .capture_time = frame_clock::time_point(
+                std::chrono::duration_cast<frame_clock::duration>(std::chrono::nanoseconds(capture_ns))),
+        };
+    }
+};
+
+static_assert(sizeof(frame_header_record) == 16);
+static_assert(std::is_standard_layout_v<frame_header_record> && std::is_trivially_copyable_v<frame_header_record>);
+
+/// Optional per-frame data that most stages never look at.
+struct frame_metadata {
+    frame_clock::time_point deadline {};   // process-local, like the whole table: never serialized
+    uint64_t checksum {};
+    uint32_t source_id {};
+    uint32_t user_flags {};
+};
+
+/// A process-wide pool of `frame_metadata` entries addressed by slot number.
+///
+/// Entries are allocated in chunks that are never freed, so a slot number stays valid for the life of
+/// the process and `operator[]` needs no lock. Free slots form a lock-free stack.
+class frame_metadata_table {
+public:
+    static constexpr uint32_t chunk_slots = 256;
+    static constexpr uint32_t max_chunks = 1024;
+
+    static frame_metadata_table& instance() {
+        static auto* table = new frame_metadata_table(); // leaked: frames may outlive static destruction
+        return *table;
+    }
+
+    /// A slot holding a value-initialized entry.
+    uint32_t acquire() {
+        for (;;) {
+            auto head = free_head_.load(std::memory_order_acquire);
+            auto top = static_cast<uint32_t>(head);
+            if (top == 0) {
+                grow();
+                continue;
+            }
+
+            auto slot = top - 1;
+            auto next = entry_at(slot).next_free.load(std::memory_order_relaxed);
+            auto tag = (head >> 32) + 1;
+            if (free_head_.compare_exchange_weak(head, (tag << 32) | next, std::memory_order_acquire)) {
+                entry_at(slot).value = frame_metadata {};
+                return slot;
+            }
+        }
+    }
+
+    void release(uint32_t slot) noexcept {
+        auto& entry = entry_at(slot);
+        auto head = free_head_.load(std::memory_order_relaxed);
+        for (;;) {
+            entry.next_free.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            auto tag = (head >> 32) + 1;
+            if (free_head_.compare_exchange_weak(head, (tag << 32) | (slot + 1), std::memory_order_release)) {
+                return;
+            }
+        }
+    }
+
+    frame_metadata& operator[](uint32_t slot) noexcept {
+        return entry_at(slot).value;
+    }
+
+    /// Slots allocated so far, in use or free.
+    std::size_t capacity() const noexcept {
+        return chunk_count_.load(std::memory_order_acquire) * std::size_t(chunk_slots);
+    }
+
+private:
+    struct entry {
+        frame_metadata value;
+        std::atomic<uint32_t> next_free;    // slot + 1 of the next free entry, 0 for none
+    };
+
+    frame_metadata_table() = default;
+
+    entry& entry_at(uint32_t slot) const noexcept {
+        return chunks_[slot / chunk_slots].load(std::memory_order_acquire)[slot % chunk_slots];
+    }
+
+    void grow() {
+        auto lock = std::unique_lock(grow_mutex_);
+        if (static_cast<uint32_t>(free_head_.load(std::memory_order_acquire)) != 0) {
+            return; // another thread grew the table
+        }
+
+        auto chunk = chunk_count_.load(std::memory_order_relaxed);
+        if (chunk == max_chunks) {
+            throw std::bad_alloc();
+        }
+        chunks_[chunk].store(new entry[chunk_slots], std::memory_order_release);
+        chunk_count_.store(chunk + 1, std::memory_order_release);
+
+        for (uint32_t i = 0; i < chunk_slots; ++i) {
+            release(chunk * chunk_slots + i);
+        }
+    }
+
+    std::atomic<uint64_t> free_head_ {};                // (ABA tag << 32) | (slot + 1)
+    std::array<std::atomic<entry*>, max_chunks> chunks_ {};
+    std::atomic<uint32_t> chunk_count_ {};
+    std::mutex grow_mutex_;
+};
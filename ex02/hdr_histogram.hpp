@@ -0,0 +1,241 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+/// A High Dynamic Range histogram of non-negative integer values, e.g. latencies in nanoseconds,
+/// after Gil Tene's HdrHistogram.
+///
+/// Values up to `highest` are kept with `significant_digits` decimal digits of precision: buckets
+/// double in width, each split into enough linear sub-buckets for that precision. Memory is fixed at
+/// construction (about 260 KiB for 1 ns .. 1 h at 3 digits), recording is a few shifts and an increment,
+/// and any percentile, p99.99 included, is read with the same relative error, so a long run can be
+/// recorded whole instead of sampled.
+///
+/// `write_percentiles` prints the percentile distribution in HdrHistogram's text format, which its
+/// plotting tools read to compare runs against an SLO curve.
+class hdr_histogram {
+public:
+    explicit hdr_histogram(int64_t highest = 3'600'000'000'000, int significant_digits = 3, int64_t lowest = 1)
+        : highest_(highest) {
+        if (lowest < 1 || highest < 2 * lowest || significant_digits < 1 || significant_digits > 5) {
+            throw std::invalid_argument("hdr_histogram: needs 1 <= lowest, 2 * lowest <= highest, 1 to 5 digits");
+        }
+
+        auto largest_single_unit = 2 * static_cast<int64_t>(std::pow(10, significant_digits));
+        auto sub_bucket_count_magnitude = static_cast<int>(std::ceil(std::log2(static_cast<double>(largest_single_unit))));
+        sub_bucket_half_count_magnitude_ = std::max(sub_bucket_count_magnitude, 1) - 1;
+        unit_magnitude_ = std::bit_width(static_cast<uint64_t>(lowest)) - 1;
+        sub_bucket_count_ = int64_t(1) << (sub_bucket_half_count_magnitude_ + 1);
+        sub_bucket_half_count_ = sub_bucket_count_ / 2;
+        sub_bucket_mask_ = (sub_bucket_count_ - 1) << unit_magnitude_;
+
+        // buckets needed to cover `highest`
+        auto smallest_untrackable = sub_bucket_count_ << unit_magnitude_;
+        bucket_count_ = 1;
+        while (smallest_untrackable <= highest) {
+            if (smallest_untrackable > std::numeric_limits<int64_t>::max() / 2) {
+                ++bucket_count_;
+                break;
+            }
+            smallest_untrackable <<= 1;
+            ++bucket_count_;
+        }
+        counts_.resize(static_cast<std::size_t>((bucket_count_ + 1) * sub_bucket_half_count_));
+        reset();
+    }
+
+    /// Records `value`, clamped to [0, highest].
+    void record(int64_t value, uint64_t n = 1) noexcept {
+        value = std::clamp<int64_t>(value, 0, highest_);
+        counts_[index_of(value)] += n;
+        total_ += n;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+        sum_ += static_cast<double>(value) * static_cast<double>(n);
+    }
+
+    /// For closed-loop measurements, where the source waits for the system under test: records
+    /// `value` and the samples that requests due every `expected_interval` would have recorded while
+    /// it was in progress (value - interval, value - 2 * interval, ...). An open-loop source measuring
+    /// from intended send times needs no correction.
+    void record_corrected(int64_t value, int64_t expected_interval) noexcept {
+        record(value);
+        if (expected_interval <= 0) return;
+        for (auto missing = value - expected_interval; missing >= expected_interval; missing -= expected_interval) {
+            record(missing);
+        }
+    }
+
+    /// Adds `other`'s counts; both must have been constructed with the same arguments.
+    void add(const hdr_histogram& other) {
+        if (other.counts_.size() != counts_.size() || other.unit_magnitude_ != unit_magnitude_
+            || other.sub_bucket_count_ != sub_bucket_count_) {
+            throw std::invalid_argument("hdr_histogram: adding a histogram of another layout");
+        }
+        for (std::size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+        sum_ += other.sum_;
+    }
+
+    void reset() noexcept {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        total_ = 0;
+        min_ = std::numeric_limits<int64_t>::max();
+        max_ = 0;
+        sum_ = 0;
+    }
+
+    uint64_t count() const noexcept {
+        return total_;
+    }
+
+    int64_t min() const noexcept {
+        return total_ ? min_ : 0;
+    }
+
+    int64_t max() const noexcept {
+        return total_ ? highest_equivalent(max_) : 0;
+    }
+
+    double mean() const noexcept {
+        return total_ ? sum_ / static_cast<double>(total_) : 0;
+    }
+
+    /// The value at `percentile` (0 to 100): no more than `percentile`% of the recorded values are
+    /// above it. Reported as the top of its sub-bucket, so it errs on the high side.
+    int64_t value_at_percentile(double percentile) const noexcept {
+        if (!total_) return 0;
+        if (percentile <= 0) return min();
+        auto target = count_at_percentile(percentile);
+        auto cumulative = uint64_t {};
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            cumulative += counts_[i];
+            if (cumulative >= target) return std::min(highest_equivalent(value_from_index(i)), max());
+        }
+        return max();
+    }
+
+    /// HdrHistogram's percentile distribution: value, percentile, count at or below the value and
+    /// 1/(1-percentile), with `ticks_per_half` lines per halving of the distance to 100%. Values are
+    /// divided by `value_scale`, e.g. 1000 to print nanoseconds as microseconds.
+    void write_percentiles(std::ostream& out, double value_scale = 1000, int ticks_per_half = 5) const {
+        auto flags = out.flags();
+        auto precision = out.precision();
+        out << std::fixed << std::right << std::setw(12) << "Value" << " " << std::setw(14) << "Percentile" << " "
+            << std::setw(10) << "TotalCount" << " " << std::setw(14) << "1/(1-Percentile)" << "\n\n";
+
+        auto line = [&](int64_t value, double percentile, uint64_t cumulative) {
+            out << std::setprecision(3) << std::setw(12) << static_cast<double>(value) / value_scale << " "
+                << std::setprecision(12) << std::setw(14) << percentile / 100 << " " << std::setw(10) << cumulative;
+            if (percentile < 100) out << " " << std::setprecision(2) << std::setw(14) << 1 / (1 - percentile / 100);
+            out << "\n";
+        };
+
+        if (total_) {
+            auto percentile = 0.0;
+            auto i = std::size_t {};
+            auto cumulative = counts_[0];
+            for (;;) {
+                // the first sub-bucket whose cumulative count reaches `percentile`
+                auto target = count_at_percentile(percentile);
+                while (cumulative < target && i + 1 < counts_.size()) cumulative += counts_[++i];
+                if (cumulative >= total_) break;
+                line(std::min(highest_equivalent(value_from_index(i)), max()), percentile, cumulative);
+
+                auto halvings = std::floor(std::log2(100 / (100 - percentile)));
+                percentile += 100 / (ticks_per_half * std::exp2(halvings + 1));
+            }
+        }
+        line(max(), 100, total_);
+
+        auto stddev = 0.0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            if (!counts_[i]) continue;
+            auto deviation = static_cast<double>(median_equivalent(value_from_index(i))) - mean();
+            stddev += deviation * deviation * static_cast<double>(counts_[i]);
+        }
+        stddev = total_ ? std::sqrt(stddev / static_cast<double>(total_)) : 0;
+
+        out << std::setprecision(3)
+            << "#[Mean    = " << std::setw(12) << mean() / value_scale << ", StdDeviation   = " << std::setw(12)
+            << stddev / value_scale << "]\n"
+            << "#[Max     = " << std::setw(12) << static_cast<double>(max()) / value_scale << ", Total count    = "
+            << std::setw(12) << total_ << "]\n"
+            << "#[Buckets = " << std::setw(12) << bucket_count_ << ", SubBuckets     = " << std::setw(12)
+            << sub_bucket_count_ << "]\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+private:
+    uint64_t count_at_percentile(double percentile) const noexcept {
+        auto count = static_cast<uint64_t>(std::min(percentile, 100.0) / 100 * static_cast<double>(total_) + 0.5);
+        return std::max<uint64_t>(count, 1);
+    }
+
+    int bucket_index(int64_t value) const noexcept {
+        auto pow2_ceiling = std::bit_width(static_cast<uint64_t>(value | sub_bucket_mask_));
+        return pow2_ceiling - unit_magnitude_ - (sub_bucket_half_count_magnitude_ + 1);
+    }
+
+    std::size_t index_of(int64_t value) const noexcept {
+        auto bucket = bucket_index(value);
+        auto sub_bucket = value >> (bucket + unit_magnitude_);
+        return static_cast<std::size_t>(((int64_t(bucket) + 1) << sub_bucket_half_count_magnitude_)
+                                        + (sub_bucket - sub_bucket_half_count_));
+    }
+
+    int64_t value_from_index(std::size_t index) const noexcept {
+        auto bucket = static_cast<int>(index >> sub_bucket_half_count_magnitude_) - 1;
+        auto sub_bucket = static_cast<int64_t>(index & static_cast<std::size_t>(sub_bucket_half_count_ - 1)) + sub_bucket_half_count_;
+        if (bucket < 0) {
+            sub_bucket -= sub_bucket_half_count_;
+            bucket = 0;
+        }
+        return sub_bucket << (bucket + unit_magnitude_);
+    }
+
+    int64_t equivalent_range(int64_t value) const noexcept {
+        auto bucket = bucket_index(value);
+        auto sub_bucket = value >> (bucket + unit_magnitude_);
+        return int64_t(1) << (unit_magnitude_ + bucket + (sub_bucket >= sub_bucket_count_ ? 1 : 0));
+    }
+
+    int64_t lowest_equivalent(int64_t value) const noexcept {
+        auto bucket = bucket_index(value);
+        auto sub_bucket = value >> (bucket + unit_magnitude_);
+        return sub_bucket << (bucket + unit_magnitude_);
+    }
+
+    int64_t highest_equivalent(int64_t value) const noexcept {
+        return lowest_equivalent(value) + equivalent_range(value) - 1;
+    }
+
+    int64_t median_equivalent(int64_t value) const noexcept {
+        return lowest_equivalent(value) + equivalent_range(value) / 2;
+    }
+
+    int64_t highest_;
+    int unit_magnitude_ {};
+    int sub_bucket_half_count_magnitude_ {};
+    int64_t sub_bucket_count_ {};
+    int64_t sub_bucket_half_count_ {};
+    int64_t sub_bucket_mask_ {};
+    int64_t bucket_count_ {};
+    std::vector<uint64_t> counts_;
+    uint64_t total_ {};
+    int64_t min_ {};
+    int64_t max_ {};
+    double sum_ {};
+};
@@ -0,0 +1,265 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/// Pages actually backing a `hugepage_region`.
+enum class page_backing {
+    normal,             // base pages (transparent huge pages disabled for the region)
+    transparent_huge,   // base-page mapping advised for THP, and THP enabled; when prefaulted, huge pages were seen
+    hugetlb_2mb,
+    hugetlb_1gb,
+};
+
+inline const char* to_string(page_backing backing) noexcept {
+    switch (backing) {
+    case page_backing::normal: return "4k";
+    case page_backing::transparent_huge: return "thp";
+    case page_backing::hugetlb_2mb: return "hugetlb_2mb";
+    case page_backing::hugetlb_1gb: return "hugetlb_1gb";
+    }
+    return "?";
+}
+
+/// One anonymous mapping, optionally backed by huge pages, so that multi-megabyte frames cost a
+/// handful of TLB entries instead of thousands.
+///
+/// `MAP_HUGETLB` needs pages reserved by the administrator (`vm.nr_hugepages`); when none are
+/// available the region falls back to a 2 MB-aligned mapping advised for transparent huge pages.
+/// With `prefault` every page is touched up front so the first frames do not pay for page faults.
+///
+/// `madvise(MADV_HUGEPAGE)` succeeds even when THP is switched off, so the region only reports
+/// `transparent_huge` if THP is enabled (`/sys/kernel/mm/transparent_hugepage/enabled` is not
+/// `never`) and, once prefaulted, `/proc/self/smaps` shows huge pages in the range.
+class hugepage_region {
+public:
+    struct options {
+        page_backing pages = page_backing::hugetlb_2mb;
+        bool prefault = true;
+    };
+
+    static constexpr std::size_t huge_2mb = std::size_t(2) << 20;
+    static constexpr std::size_t huge_1gb = std::size_t(1) << 30;
+
+    explicit hugepage_region(std::size_t bytes) : hugepage_region(bytes, options {}) {}
+
+    hugepage_region(std::size_t bytes, options opts) {
+#if defined(MAP_HUGETLB)
+        if (opts.pages == page_backing::hugetlb_1gb || opts.pages == page_backing::hugetlb_2mb) {
+            auto huge_1g = opts.pages == page_backing::hugetlb_1gb;
+            auto page = huge_1g ? huge_1gb : huge_2mb;
+            auto flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (opts.prefault ? MAP_POPULATE : 0);
+#if defined(MAP_HUGE_SHIFT)
+            flags |= (huge_1g ? 30 : 21) << MAP_HUGE_SHIFT;
+#endif
+            auto size = round_up(bytes, page);
+            auto addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (addr != MAP_FAILED) {
+                base_ = addr;
+                data_ = static_cast<std::byte*>(addr);
+                bytes_ = mapped_ = size;
+                backing_ = opts.pages;
+                return;
+            }
+            // no reserved huge pages: fall back to THP
+        }
+#endif
+        map_base_pages(bytes, opts);
+    }
+
+    ~hugepage_region() {
+        if (base_) ::munmap(base_, mapped_);
+    }
+
+    hugepage_region(const hugepage_region&) = delete;
+    hugepage_region& operator=(const hugepage_region&) = delete;
+
+    std::byte* data() const noexcept {
+        return data_;
+    }
+
+    std::size_t size() const noexcept {
+        return bytes_;
+    }
+
+    page_backing backing() const noexcept {
+        return backing_;
+    }
+
+    bool contains(const void* p) const noexcept {
+        auto b = static_cast<const std::byte*>(p);
+        return b >= data_ && b < data_ + bytes_;
+    }
+
+private:
+    static std::size_t round_up(std::size_t n, std::size_t to) noexcept {
+        return (n + to - 1) / to * to;
+    }
+
+    void map_base_pages(std::size_t bytes, options opts) {
+        // over-allocate so the region can start on a 2 MB boundary, where THP can back it
+        bytes_ = round_up(bytes, huge_2mb);
+        mapped_ = bytes_ + huge_2mb;
+        auto addr = ::mmap(nullptr, mapped_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (addr == MAP_FAILED) {
+            throw std::system_error(errno, std::system_category(), "mmap");
+        }
+        base_ = addr;
+        data_ = reinterpret_cast<std::byte*>(round_up(reinterpret_cast<std::uintptr_t>(addr), huge_2mb));
+
+        backing_ = page_backing::normal;
+#if defined(MADV_HUGEPAGE)
+        if (opts.pages != page_backing::normal && ::madvise(data_, bytes_, MADV_HUGEPAGE) == 0 && thp_enabled()) {
+            backing_ = page_backing::transparent_huge;
+        } else if (opts.pages == page_backing::normal) {
+            ::madvise(data_, bytes_, MADV_NOHUGEPAGE);
+        }
+#endif
+
+        if (opts.prefault) {
+            // write, not read: reads of untouched anonymous memory all map the shared zero page
+            auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            for (std::size_t offset = 0; offset < bytes_; offset += page) {
+                static_cast<volatile std::byte*>(data_)[offset] = std::byte {};
+            }
+            if (backing_ == page_backing::transparent_huge && anon_huge_bytes() == 0) {
+                backing_ = page_backing::normal; // e.g. no free 2 MB blocks, or defrag off
+            }
+        }
+    }
+
+    // the selected mode is the bracketed one, e.g. "always [madvise] never"
+    static bool thp_enabled() {
+        auto file = std::ifstream("/sys/kernel/mm/transparent_hugepage/enabled");
+        auto modes = std::string();
+        if (!std::getline(file, modes)) return false;
+        return modes.find("[never]") == std::string::npos;
+    }
+
+    // AnonHugePages of the mappings overlapping the region; the madvise may have split it off
+    // from the alignment slack into a mapping of its own
+    std::size_t anon_huge_bytes() const {
+        auto smaps = std::ifstream("/proc/self/smaps");
+        auto begin = reinterpret_cast<std::uintptr_t>(data_);
+        auto end = begin + bytes_;
+        auto overlaps = false;
+        auto total = std::size_t {};
+        for (auto line = std::string(); std::getline(smaps, line);) {
+            auto dash = line.find('-');
+            if (dash != std::string::npos && dash > 0 && line.find(' ') > dash) {
+                // a mapping header: "start-end perms offset dev inode path"
+                std::uintptr_t start {}, stop {};
+                auto in = std::istringstream(line);
+                char sep {};
+                if (in >> std::hex >> start >> sep >> stop) {
+                    overlaps = start < end && stop > begin;
+                    continue;
+                }
+            }
+            if (overlaps && line.rfind("AnonHugePages:", 0) == 0) {
+                auto in = std::istringstream(line.substr(14));
+                auto kb = std::size_t {};
+                in >> kb;
+                total += kb * 1024;
+            }
+        }
+        return total;
+    }
+
+    void* base_ {};             // what was mapped, for munmap
+    std::size_t mapped_ {};
+    std::byte* data_ {};
+    std::size_t bytes_ {};
+    page_backing backing_ {};
+};
+
+/// A pool of equally sized frame buffers carved out of one `hugepage_region`.
+///
+/// As a `std::pmr::memory_resource` it serves any request up to `buffer_bytes()` from the region and
+/// passes larger requests, or requests made while the pool is exhausted, to `upstream`.
+class frame_buffer_pool : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t buffer_alignment = 4096;
+
+    frame_buffer_pool(std::size_t buffer_bytes, std::size_t buffer_count)
+        : frame_buffer_pool(buffer_bytes, buffer_count, hugepage_region::options {}) {
+    }
+
+    frame_buffer_pool(std::size_t buffer_bytes, std::size_t buffer_count, hugepage_region::options opts,
+                      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : buffer_bytes_((buffer_bytes + buffer_alignment - 1) / buffer_alignment * buffer_alignment)
+        , region_(buffer_bytes_ * buffer_count, opts)
+        , upstream_(upstream) {
+        free_.reserve(buffer_count);
+        for (auto i = buffer_count; i > 0; --i) {
+            free_.push_back(region_.data() + (i - 1) * buffer_bytes_);
+        }
+    }
+
+    std::size_t buffer_bytes() const noexcept {
+        return buffer_bytes_;
+    }
+
+    std::size_t available() const {
+        auto lock = std::unique_lock(mutex_);
+        return free_.size();
+    }
+
+    /// Requests that did not fit a pooled buffer and went upstream.
+    std::size_t upstream_allocations() const {
+        auto lock = std::unique_lock(mutex_);
+        return upstream_allocations_;
+    }
+
+    const hugepage_region& region() const noexcept {
+        return region_;
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        {
+            auto lock = std::unique_lock(mutex_);
+            if (bytes <= buffer_bytes_ && alignment <= buffer_alignment && !free_.empty()) {
+                auto buffer = free_.back();
+                free_.pop_back();
+                return buffer;
+            }
+            ++upstream_allocations_;
+        }
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        if (region_.contains(p)) {
+            auto lock = std::unique_lock(mutex_);
+            free_.push_back(static_cast<std::byte*>(p));
+        } else {
+            upstream_->deallocate(p, bytes, alignment);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    std::size_t buffer_bytes_;
+    hugepage_region region_;
+    std::pmr::memory_resource* upstream_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::byte*> free_;
+    std::size_t upstream_allocations_ {};
+};
@@ -1,6 +1,8 @@
 // Copyright (c) 2025 Peter Tran. All rights reserved.
 
+#include <algorithm>
 #include <iostream>
+#include <memory_resource>
 #include <exec/async_scope.hpp>
 #include <exec/repeat_effect_until.hpp>
 #include <exec/sequence/ignore_all_values.hpp>
@@ -9,8 +11,11 @@
 #include <exec/single_thread_context.hpp>
 #include <exec/static_thread_pool.hpp>
 
+#include "checkpoint.hpp"
 #include "ondemand_range.hpp"
 #include "decoder.hpp"
+#include "metrics_http.hpp"
+#include "scratch_arena.hpp"
 
 auto make_frame_sequence(hw_decoder& decoder) {
     return ondemand_sequence<hw_frame>(
@@ -22,32 +27,65 @@ auto make_frame_sequence(hw_decoder& decoder) {
     );
 }
 
-void process_frame(auto&& frame, int32_t& total) {
+void process_frame(auto&& frame, int64_t& total, scratch_arena& scratch) {
     static_assert(std::is_rvalue_reference_v<decltype(frame)>);
 
-    std::cout << "frame_reader: [" << frame.index << "]: " << frame.data[0] << std::endl;
+    // working copy from the worker's scratch arena: a pointer bump, released after the frame
+    auto sorted = std::pmr::vector<int32_t>(frame.data.begin(), frame.data.end(), &scratch);
+    std::ranges::sort(sorted);
+
+    std::cout << "frame_reader: [" << frame.index << "]: " << frame.data[0]
+              << ", median: " << sorted[sorted.size() / 2] << std::endl;
     total += frame.index;
 }
 
-int main() {
+int main(int argc, char** argv) {
     auto transfer_context = exec::single_thread_context();
     auto read_context = exec::single_thread_context();
     auto main_loop = stdexec::run_loop();
     auto main_scope = exec::async_scope();
 
+    // frame payloads are recycled through a pool instead of the global heap; frames are created on
+    // the decoder's thread and released on the reader's, hence the synchronized pool
+    auto frame_pool = std::pmr::synchronized_pool_resource();
+
     auto decoder = hw_decoder();
+    decoder.frame_resource = &frame_pool;
 
     // frame sequence is an input_range that knows how to fetch frames from decoder
     auto frame_sequence = make_frame_sequence(decoder);
 
-    int total = 0;
+    int64_t total = 0;
+
+    // ex02 [checkpoint-file] [metrics-port]: serve metrics on http://127.0.0.1:<metrics-port>/metrics
+    auto metrics_server = std::optional<metrics_http_server>();
+    if (argc > 2) {
+        metrics_server.emplace(metrics_registry::global(), static_cast<uint16_t>(std::stoi(argv[2])));
+        std::cout << "metrics on port " << metrics_server->port() << std::endl;
+    }
+
+    // ex02 [checkpoint-file]: resume after the last processed frame of a previous run
+    auto checkpoint = std::optional<checkpoint_file>();
+    if (argc > 1) {
+        checkpoint.emplace(argv[1]);
+        if (auto saved = checkpoint->load()) {
+            std::cout << "resuming after frame " << saved->last_index << std::endl;
+            decoder.seek(saved->last_index + 1);
+            total = saved->total;
+        }
+    }
+
     auto frame_reader =
         read_context.get_scheduler().schedule()
         | stdexec::let_value([&] {
             return
                 exec::iterate(std::move(frame_sequence))
-                | exec::transform_each(stdexec::then([&total](auto&& frame) {
-                    process_frame(std::forward<decltype(frame)>(frame), total);
+                | exec::transform_each(then_with_scratch([&total, &checkpoint](auto&& frame, scratch_arena& scratch) {
+                    auto index = frame.index;
+                    process_frame(std::forward<decltype(frame)>(frame), total, scratch);
+                    if (checkpoint) {
+                        checkpoint->update({ index, total });
+                    }
                 }))
                 | exec::ignore_all_values()
 
@@ -0,0 +1,240 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include "metrics.hpp"
+
+/// Bytes a buffered item keeps alive: the object itself and, for frames, the payload.
+template <typename Item>
+std::size_t frame_footprint(const Item& item) noexcept {
+    if constexpr (requires { std::span(item.data); }) {
+        return sizeof(Item) + std::span(item.data).size_bytes();
+    } else {
+        return sizeof(Item);
+    }
+}
+
+/// A process-wide limit on the bytes held by frame-buffering stages (prefetch queues, stream
+/// buffers, send batches, caches).
+///
+/// Each stage registers once and reserves before it takes a frame in, releasing when the frame
+/// leaves. When the budget is used up, `reserve` blocks: the stage stops pulling from its producer,
+/// which backs up to the decoder instead of the process growing until it is OOM-killed.
+///
+/// To keep stages that wait on each other from deadlocking, a stage that holds nothing always gets
+/// one frame in (`starving`), even over the limit; so does any reservation while nothing else is
+/// reserved. The limit can therefore be exceeded by at most one frame per stage queue.
+///
+/// `snapshot()` and `operator<<` give the live breakdown by stage; `report_to(registry)` also
+/// exports it as metrics, one series per stage:
+///
+///     memory_budget_bytes{stage="send batch"}, memory_budget_peak_bytes, memory_budget_throttled_total
+///
+/// plus `memory_budget_limit_bytes`. The registry must outlive the budget (the global one does).
+class memory_budget {
+public:
+    class stage {
+    public:
+        stage(memory_budget& budget, std::string name) : budget_(&budget), name_(std::move(name)) {}
+
+        stage(const stage&) = delete;
+        stage& operator=(const stage&) = delete;
+
+        /// Blocks until `bytes` fit the budget, or until `starving()` (checked whenever memory is
+        /// released) says the caller's queue ran empty; false if `stop` was requested first.
+        template <typename Starving>
+        bool reserve(std::size_t bytes, std::stop_token stop, Starving starving) {
+            return budget_->acquire(*this, bytes, stop, starving);
+        }
+
+        bool reserve(std::size_t bytes, std::stop_token stop = {}) {
+            return reserve(bytes, std::move(stop), [] { return false; });
+        }
+
+        bool try_reserve(std::size_t bytes) {
+            return budget_->try_acquire(*this, bytes);
+        }
+
+        /// Counts `bytes` without waiting, even over the limit.
+        void force_reserve(std::size_t bytes) {
+            budget_->force_acquire(*this, bytes);
+        }
+
+        void release(std::size_t bytes) noexcept {
+            budget_->release(*this, bytes);
+        }
+
+        const std::string& name() const noexcept {
+            return name_;
+        }
+
+        std::size_t bytes() const noexcept {
+            return bytes_.load(std::memory_order_relaxed);
+        }
+
+        std::size_t peak() const noexcept {
+            return peak_.load(std::memory_order_relaxed);
+        }
+
+        /// Reservations that had to wait for other stages to release memory.
+        std::size_t throttled() const noexcept {
+            return throttled_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        friend class memory_budget;
+
+        memory_budget* budget_;
+        std::string name_;
+        std::atomic<std::size_t> bytes_ {};
+        std::atomic<std::size_t> peak_ {};
+        std::atomic<std::size_t> throttled_ {};
+
+        // set by `report_to`; updated under the budget's lock
+        metric_gauge* bytes_metric_ {};
+        metric_gauge* peak_metric_ {};
+        metric_counter* throttled_metric_ {};
+    };
+
+    struct stage_usage {
+        std::string name;
+        std::size_t bytes {};
+        std::size_t peak {};
+        std::size_t throttled {};
+    };
+
+    explicit memory_budget(std::size_t limit_bytes) : limit_(limit_bytes) {}
+
+    memory_budget(const memory_budget&) = delete;
+    memory_budget& operator=(const memory_budget&) = delete;
+
+    /// A new stage; it lives as long as the budget.
+    stage& add_stage(std::string name) {
+        auto lock = std::unique_lock(mutex_);
+        auto& s = stages_.emplace_back(*this, std::move(name));
+        if (registry_) register_metrics(s);
+        return s;
+    }
+
+    /// Export the limit and every stage, present and future, as metrics in `registry`.
+    void report_to(metrics_registry& registry) {
+        auto lock = std::unique_lock(mutex_);
+        registry_ = &registry;
+        registry.gauge("memory_budget_limit_bytes", "Bytes frame-buffering stages may hold in total.")
+            .set(static_cast<int64_t>(limit_));
+        for (auto& s : stages_) register_metrics(s);
+    }
+
+    std::size_t limit() const noexcept {
+        return limit_;
+    }
+
+    std::size_t used() const {
+        auto lock = std::unique_lock(mutex_);
+        return used_;
+    }
+
+    std::vector<stage_usage> snapshot() const {
+        auto lock = std::unique_lock(mutex_);
+        auto usage = std::vector<stage_usage>();
+        usage.reserve(stages_.size());
+        for (auto& s : stages_) {
+            usage.push_back({ s.name(), s.bytes(), s.peak(), s.throttled() });
+        }
+        return usage;
+    }
+
+    /// One line per stage: name, bytes held now, peak, throttled reservations.
+    friend std::ostream& operator<<(std::ostream& os, const memory_budget& budget) {
+        auto usage = budget.snapshot();
+        auto used = std::size_t {};
+        for (auto& s : usage) used += s.bytes;
+
+        os << "memory budget: " << used << " / " << budget.limit() << " bytes\n";
+        for (auto& s : usage) {
+            os << "  " << s.name << ": " << s.bytes << " bytes, peak " << s.peak
+               << ", throttled " << s.throttled << "\n";
+        }
+        return os;
+    }
+
+private:
+    bool try_acquire(stage& s, std::size_t bytes) {
+        auto lock = std::unique_lock(mutex_);
+        if (!fits(bytes)) return false;
+        grant(s, bytes);
+        return true;
+    }
+
+    template <typename Starving>
+    bool acquire(stage& s, std::size_t bytes, std::stop_token stop, Starving& starving) {
+        auto lock = std::unique_lock(mutex_);
+        if (!fits(bytes) && !starving()) {
+            s.throttled_.fetch_add(1, std::memory_order_relaxed);
+            if (s.throttled_metric_) s.throttled_metric_->add();
+            ++waiters_;
+            auto granted = released_.wait(lock, stop, [&] { return fits(bytes) || starving(); });
+            --waiters_;
+            if (!granted) return false;
+        }
+        grant(s, bytes);
+        return true;
+    }
+
+    void force_acquire(stage& s, std::size_t bytes) {
+        auto lock = std::unique_lock(mutex_);
+        grant(s, bytes);
+    }
+
+    void release(stage& s, std::size_t bytes) noexcept {
+        auto lock = std::unique_lock(mutex_);
+        s.bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+        used_ -= bytes;
+        if (s.bytes_metric_) s.bytes_metric_->sub(static_cast<int64_t>(bytes));
+        if (waiters_) released_.notify_all();
+    }
+
+    bool fits(std::size_t bytes) const noexcept {
+        return used_ == 0 || used_ + bytes <= limit_;
+    }
+
+    void grant(stage& s, std::size_t bytes) noexcept {
+        used_ += bytes;
+        auto held = s.bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if (s.bytes_metric_) s.bytes_metric_->add(static_cast<int64_t>(bytes));
+        if (held > s.peak_.load(std::memory_order_relaxed)) {
+            s.peak_.store(held, std::memory_order_relaxed); // only raised under the lock
+            if (s.peak_metric_) s.peak_metric_->set(static_cast<int64_t>(held));
+        }
+    }
+
+    // under the lock, so the gauges start from values no grant or release has moved yet
+    void register_metrics(stage& s) {
+        auto labels = "stage=\"" + s.name() + "\"";
+        s.bytes_metric_ = &registry_->gauge("memory_budget_bytes", "Bytes of frames a buffering stage holds.", labels);
+        s.peak_metric_ = &registry_->gauge("memory_budget_peak_bytes", "Most bytes a buffering stage held at once.", labels);
+        s.throttled_metric_ = &registry_->counter("memory_budget_throttled_total",
+                                                  "Reservations that waited for other stages to release memory.", labels);
+        s.bytes_metric_->set(static_cast<int64_t>(s.bytes()));
+        s.peak_metric_->set(static_cast<int64_t>(s.peak()));
+        s.throttled_metric_->add(s.throttled());
+    }
+
+    std::size_t limit_;
+    mutable std::mutex mutex_;
+    std::condition_variable_any released_;
+    std::size_t used_ {};
+    std::size_t waiters_ {};
+    std::deque<stage> stages_;
+    metrics_registry* registry_ {};
+};
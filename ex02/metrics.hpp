@@ -0,0 +1,279 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/// Runtime metrics: counters, gauges and histograms registered by name in a `metrics_registry`
+/// and dumped in the Prometheus text exposition format.
+///
+/// Updates are relaxed atomic operations on a per-thread shard, so threads updating the same
+/// metric do not share a cache line; reading a metric sums the shards. Registration takes a lock
+/// and is meant for setup: keep the returned reference instead of looking a metric up per event.
+
+namespace detail {
+
+inline constexpr std::size_t metric_shards = 16;
+
+// threads are spread over the shards round-robin, in order of their first update
+inline std::size_t metric_shard() noexcept {
+    static std::atomic<std::size_t> next_shard {};
+    // constant-initialized, so reading it is a plain TLS load rather than a call to an init wrapper
+    thread_local std::size_t shard = metric_shards;
+    if (shard == metric_shards) [[unlikely]] {
+        shard = next_shard.fetch_add(1, std::memory_order_relaxed) % metric_shards;
+    }
+    return shard;
+}
+
+struct alignas(64) metric_cell {
+    std::atomic<uint64_t> value {};
+};
+
+// `le` label value of a bucket bound
+inline std::string format_metric_value(double value) {
+    auto out = std::ostringstream();
+    out.precision(17);
+    out << value;
+    return out.str();
+}
+
+inline std::string join_labels(const std::string& labels, const std::string& extra) {
+    if (labels.empty()) return "{" + extra + "}";
+    return "{" + labels + "," + extra + "}";
+}
+
+} // namespace detail
+
+/// A metric series as the registry sees it.
+class metric {
+public:
+    virtual ~metric() = default;
+
+    /// Write this series' sample lines; `labels` is empty or `key="value",...` without braces.
+    virtual void write(std::ostream& out, const std::string& name, const std::string& labels) const = 0;
+};
+
+/// A monotonically increasing count, e.g. frames decoded.
+class metric_counter final : public metric {
+public:
+    void add(uint64_t n = 1) noexcept {
+        cells_[detail::metric_shard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const noexcept {
+        auto sum = uint64_t {};
+        for (auto& cell : cells_) sum += cell.value.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    void write(std::ostream& out, const std::string& name, const std::string& labels) const override {
+        out << name << (labels.empty() ? "" : "{" + labels + "}") << " " << value() << "\n";
+    }
+
+private:
+    std::array<detail::metric_cell, detail::metric_shards> cells_;
+};
+
+/// A value that goes up and down, e.g. a queue depth. Not sharded: `set` needs one location.
+class metric_gauge final : public metric {
+public:
+    void set(int64_t value) noexcept {
+        value_.store(value, std::memory_order_relaxed);
+    }
+
+    void add(int64_t n = 1) noexcept {
+        value_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void sub(int64_t n = 1) noexcept {
+        value_.fetch_sub(n, std::memory_order_relaxed);
+    }
+
+    int64_t value() const noexcept {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+    void write(std::ostream& out, const std::string& name, const std::string& labels) const override {
+        out << name << (labels.empty() ? "" : "{" + labels + "}") << " " << value() << "\n";
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> value_ {};
+};
+
+/// Distribution of observations (e.g. latencies in seconds) over fixed buckets.
+class metric_histogram final : public metric {
+public:
+    /// `bounds` are the buckets' inclusive upper bounds, ascending; +Inf is implied.
+    explicit metric_histogram(std::vector<double> bounds)
+        : bounds_(std::move(bounds))
+        , stride_((bounds_.size() + 1 + 7) / 8 * 8) // whole cache lines per shard
+        , counts_(std::make_unique<std::atomic<uint64_t>[]>(stride_ * detail::metric_shards)) {
+        std::sort(bounds_.begin(), bounds_.end());
+    }
+
+    /// Bounds growing by `factor` from `start`, e.g. `exponential_bounds(1e-6, 2, 24)` for 1 us .. 8 s.
+    static std::vector<double> exponential_bounds(double start, double factor, std::size_t count) {
+        auto bounds = std::vector<double>(count);
+        for (auto& bound : bounds) {
+            bound = start;
+            start *= factor;
+        }
+        return bounds;
+    }
+
+    void observe(double value) noexcept {
+        auto bucket = static_cast<std::size_t>(std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin());
+        auto shard = detail::metric_shard();
+        counts_[shard * stride_ + bucket].fetch_add(1, std::memory_order_relaxed);
+        sums_[shard].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const noexcept {
+        auto total = uint64_t {};
+        for (std::size_t bucket = 0; bucket <= bounds_.size(); ++bucket) total += bucket_count(bucket);
+        return total;
+    }
+
+    double sum() const noexcept {
+        auto total = 0.0;
+        for (auto& s : sums_) total += s.value.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    void write(std::ostream& out, const std::string& name, const std::string& labels) const override {
+        auto cumulative = uint64_t {};
+        for (std::size_t bucket = 0; bucket <= bounds_.size(); ++bucket) {
+            cumulative += bucket_count(bucket);
+            auto le = bucket < bounds_.size() ? detail::format_metric_value(bounds_[bucket]) : "+Inf";
+            out << name << "_bucket" << detail::join_labels(labels, "le=\"" + le + "\"") << " " << cumulative << "\n";
+        }
+        auto suffix = labels.empty() ? "" : "{" + labels + "}";
+        out << name << "_sum" << suffix << " " << detail::format_metric_value(sum()) << "\n";
+        out << name << "_count" << suffix << " " << cumulative << "\n";
+    }
+
+private:
+    struct alignas(64) sum_cell {
+        std::atomic<double> value {};
+    };
+
+    uint64_t bucket_count(std::size_t bucket) const noexcept {
+        auto total = uint64_t {};
+        for (std::size_t shard = 0; shard < detail::metric_shards; ++shard) {
+            total += counts_[shard * stride_ + bucket].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    std::vector<double> bounds_;
+    std::size_t stride_;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::array<sum_cell, detail::metric_shards> sums_;
+};
+
+/// Metrics by name. A name is one metric family (one type and help text); `labels`
+/// (`key="value",...`) tell its series apart. Asking again for the same name and labels returns
+/// the same metric. Metrics live as long as the registry.
+class metrics_registry {
+public:
+    /// The process-wide registry the library's components report to.
+    static metrics_registry& global() {
+        static auto* registry = new metrics_registry(); // leaked: used by threads that may outlive main
+        return *registry;
+    }
+
+    metric_counter& counter(const std::string& name, const std::string& help, const std::string& labels = {}) {
+        return get<metric_counter>(name, help, "counter", labels, [] { return std::make_unique<metric_counter>(); });
+    }
+
+    metric_gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = {}) {
+        return get<metric_gauge>(name, help, "gauge", labels, [] { return std::make_unique<metric_gauge>(); });
+    }
+
+    metric_histogram& histogram(const std::string& name, const std::string& help, std::vector<double> bounds,
+                                const std::string& labels = {}) {
+        return get<metric_histogram>(name, help, "histogram", labels,
+                                     [&] { return std::make_unique<metric_histogram>(std::move(bounds)); });
+    }
+
+    /// Prometheus text exposition format (version 0.0.4).
+    void write(std::ostream& out) const {
+        auto lock = std::unique_lock(mutex_);
+        for (auto& [name, fam] : families_) {
+            out << "# HELP " << name << " " << fam.help << "\n";
+            out << "# TYPE " << name << " " << fam.type << "\n";
+            for (auto& [labels, series] : fam.series) {
+                series->write(out, name, labels);
+            }
+        }
+    }
+
+    std::string to_string() const {
+        auto out = std::ostringstream();
+        write(out);
+        return out.str();
+    }
+
+    /// Write the dump to `<path>.tmp` and rename it over `path`, so a scraper reading the file
+    /// (e.g. node_exporter's textfile collector) never sees a partial dump.
+    void write_file(const std::filesystem::path& path) const {
+        auto tmp_path = path;
+        tmp_path += ".tmp";
+        auto text = to_string();
+
+        int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::system_error(errno, std::system_category(), "open " + tmp_path.string());
+        }
+        auto ok = ::write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+        auto err = errno;
+        ::close(fd);
+        if (!ok) {
+            throw std::system_error(err, std::system_category(), "write " + tmp_path.string());
+        }
+        std::filesystem::rename(tmp_path, path);
+    }
+
+private:
+    struct family {
+        std::string help;
+        std::string type;
+        std::map<std::string, std::unique_ptr<metric>> series;
+    };
+
+    family& family_of(const std::string& name, const std::string& help, const char* type) {
+        auto [it, inserted] = families_.try_emplace(name, family { help, type, {} });
+        if (!inserted && it->second.type != type) {
+            throw std::logic_error("metric " + name + " is a " + it->second.type + ", not a " + type);
+        }
+        return it->second;
+    }
+
+    template <typename Metric, typename Make>
+    Metric& get(const std::string& name, const std::string& help, const char* type, const std::string& labels, Make make) {
+        auto lock = std::unique_lock(mutex_);
+        auto& series = family_of(name, help, type).series[labels];
+        if (!series) series = make();
+        return static_cast<Metric&>(*series);
+    }
+
+    mutable std::mutex mutex_;
+    std::map<std::string, family> families_;
+};
@@ -0,0 +1,117 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "metrics.hpp"
+
+/// Serves a `metrics_registry` over HTTP on `127.0.0.1:port` for a Prometheus scraper:
+/// every request gets the current dump (`curl http://127.0.0.1:9464/metrics`).
+///
+/// Requests are handled one at a time on the server's own thread, so scraping never runs on (or
+/// waits for) pipeline threads. Port 0 picks a free port; see `port()`.
+class metrics_http_server {
+public:
+    explicit metrics_http_server(metrics_registry& registry, uint16_t port = 0) : registry_(registry) {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) throw_error("socket");
+
+        int one = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        auto addr = sockaddr_in {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) throw_error("bind");
+        if (::listen(listen_fd_, 4) < 0) throw_error("listen");
+
+        auto length = socklen_t(sizeof(addr));
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &length);
+        port_ = ntohs(addr.sin_port);
+
+        if (::pipe(wake_) < 0) throw_error("pipe");
+        thread_ = std::thread([this] { serve(); });
+    }
+
+    ~metrics_http_server() {
+        char stop = 0;
+        (void)::write(wake_[1], &stop, 1);
+        thread_.join();
+        ::close(wake_[0]);
+        ::close(wake_[1]);
+        ::close(listen_fd_);
+    }
+
+    metrics_http_server(const metrics_http_server&) = delete;
+    metrics_http_server& operator=(const metrics_http_server&) = delete;
+
+    uint16_t port() const noexcept {
+        return port_;
+    }
+
+private:
+    [[noreturn]] void throw_error(const char* what) {
+        auto err = errno;
+        if (listen_fd_ >= 0) ::close(listen_fd_);
+        throw std::system_error(err, std::system_category(), what);
+    }
+
+    void serve() {
+        for (;;) {
+            pollfd fds[] = { { listen_fd_, POLLIN, 0 }, { wake_[0], POLLIN, 0 } };
+            if (::poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            if (fds[1].revents) return;
+
+            auto fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) continue;
+            respond(fd);
+            ::close(fd);
+        }
+    }
+
+    void respond(int fd) {
+        // the request line and headers are not needed: every path gets the dump
+        char request[1024];
+        timeval timeout { 1, 0 };
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        (void)::recv(fd, request, sizeof(request), 0);
+
+        auto body = registry_.to_string();
+        auto response = "HTTP/1.1 200 OK\r\n"
+                        "Content-Type: text/plain; version=0.0.4\r\n"
+                        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                        "Connection: close\r\n\r\n" + body;
+
+#ifdef MSG_NOSIGNAL
+        constexpr int flags = MSG_NOSIGNAL;
+#else
+        constexpr int flags = 0;
+#endif
+        for (std::size_t sent = 0; sent < response.size();) {
+            auto n = ::send(fd, response.data() + sent, response.size() - sent, flags);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;
+            sent += static_cast<std::size_t>(n);
+        }
+    }
+
+    metrics_registry& registry_;
+    int listen_fd_ { -1 };
+    int wake_[2] { -1, -1 };
+    uint16_t port_ {};
+    std::thread thread_;
+};
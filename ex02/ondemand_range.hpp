@@ -2,6 +2,7 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
@@ -10,6 +11,8 @@
 #include <exec/any_sender_of.hpp>
 #include <stdexec/execution.hpp>
 
+#include "metrics.hpp"
+
 template <class... Ts>
 using any_sender_of =
   typename exec::any_receiver_ref<stdexec::completion_signatures<Ts...>>::template any_sender<>;
@@ -82,7 +85,11 @@ public:
             auto [until_pred] = stdexec::sync_wait(until_sender_provider_()).value();
             if (until_pred) return *this;
 
+            auto& m = metrics();
+            auto start = std::chrono::steady_clock::now();
             std::tie(current_) = stdexec::sync_wait(any_item_sender_provider_()).value();
+            m.wait.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            m.items.add();
             return *this;
         }
 
@@ -117,6 +124,24 @@ public:
     }
 
 private:
+    // shared by all ondemand_ranges, in `metrics_registry::global()`
+    struct range_metrics {
+        metric_counter& items;
+        metric_histogram& wait;
+    };
+
+    static range_metrics& metrics() {
+        static auto m = [] {
+            auto& registry = metrics_registry::global();
+            return range_metrics {
+                registry.counter("ondemand_range_items_total", "Items pulled through ondemand_range."),
+                registry.histogram("ondemand_range_wait_seconds", "Time the consumer blocked waiting for an item.",
+                                   metric_histogram::exponential_bounds(1e-6, 2, 24)),
+            };
+        }();
+        return m;
+    }
+
     any_item_sender_provider<Item> any_item_sender_provider_;
     until_sender_provider until_sender_provider_;
 };
@@ -0,0 +1,88 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <exception>
+#include <memory>
+#include <utility>
+#include <stdexec/execution.hpp>
+#include <exec/async_scope.hpp>
+
+#include "slab_pool.hpp"
+
+/// Environment of work started with `spawn_pooled`: the scope's stop token, and `slab_allocator`
+/// for algorithms that allocate through `stdexec::get_allocator`.
+struct pooled_env {
+    stdexec::inplace_stop_token stop_token;
+
+    stdexec::inplace_stop_token query(stdexec::get_stop_token_t) const noexcept {
+        return stop_token;
+    }
+
+    slab_allocator<std::byte> query(stdexec::get_allocator_t) const noexcept {
+        return {};
+    }
+};
+
+namespace detail {
+
+template <typename Sender>
+struct pooled_spawn_op {
+    using allocator_t = slab_allocator<pooled_spawn_op>;
+
+    struct receiver {
+        using receiver_concept = stdexec::receiver_t;
+
+        void set_value() noexcept {
+            op->destroy();
+        }
+
+        void set_stopped() noexcept {
+            op->destroy();
+        }
+
+        void set_error(std::exception_ptr) noexcept {
+            std::terminate(); // as with async_scope::spawn
+        }
+
+        pooled_env get_env() const noexcept {
+            return op->env;
+        }
+
+        pooled_spawn_op* op;
+    };
+
+    pooled_spawn_op(Sender&& sndr, pooled_env e)
+        : env(e), state(stdexec::connect(std::move(sndr), receiver { this })) {
+    }
+
+    void destroy() noexcept {
+        auto alloc = allocator_t();
+        std::allocator_traits<allocator_t>::destroy(alloc, this);
+        alloc.deallocate(this, 1);
+    }
+
+    pooled_env env;
+    stdexec::connect_result_t<Sender, receiver> state;
+};
+
+} // namespace detail
+
+/// Like `scope.spawn(sndr)`, but the operation state comes from the calling thread's `slab_pool`
+/// instead of the heap, and is returned to it (lock-free, from any thread) on completion.
+/// Only that operation state is pooled: allocations made by the sender itself (a captured
+/// `std::function`, say) still go to the heap unless they use the environment's allocator.
+template <stdexec::sender Sender>
+void spawn_pooled(exec::async_scope& scope, Sender&& sndr) {
+    using nested_t = decltype(scope.nest(std::forward<Sender>(sndr)));
+    using op_t = detail::pooled_spawn_op<nested_t>;
+
+    auto alloc = typename op_t::allocator_t();
+    auto op = alloc.allocate(1);
+    try {
+        ::new (op) op_t(scope.nest(std::forward<Sender>(sndr)), pooled_env { scope.get_stop_token() });
+    } catch (...) {
+        alloc.deallocate(op, 1);
+        throw;
+    }
+    stdexec::start(op->state);
+}
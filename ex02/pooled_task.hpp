@@ -0,0 +1,141 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <stdexec/execution.hpp>
+
+#include "slab_pool.hpp"
+
+/// Result storage for `pooled_task<T>`.
+template <typename T>
+struct pooled_task_result {
+    template <typename U>
+    void return_value(U&& value) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T take() {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        return std::move(*value_);
+    }
+
+    std::optional<T> value_;
+    std::exception_ptr error_;
+};
+
+template <>
+struct pooled_task_result<void> {
+    void return_void() noexcept {}
+
+    void take() {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    std::exception_ptr error_;
+};
+
+/// A lazily-started coroutine whose frame is drawn from `slab_pool`.
+///
+/// The body may `co_await` any single-value sender, e.g. `co_await async_decode_frame<hw_frame>(&decoder)`;
+/// the sender's operation state lives inline in the coroutine frame rather than in an allocation of its
+/// own. Whatever the sender allocates internally still comes from the heap, e.g. the decoder's
+/// `std::function` callback.
+/// A `pooled_task` is itself awaitable, and therefore also a sender (`sync_wait`, `starts_on`, ...).
+///
+/// `exec::task` offers no hook for its frame allocation, hence this small task type.
+/// Stop requests raised by awaited senders propagate to the awaiting coroutine as with `exec::task`.
+template <typename T>
+class pooled_task {
+public:
+    struct promise_type
+        : pooled_task_result<T>
+        , stdexec::with_awaitable_senders<promise_type> {
+
+        static void* operator new(std::size_t size) {
+            return slab_pool::allocate(size);
+        }
+
+        static void operator delete(void* p, std::size_t size) noexcept {
+            slab_pool::deallocate(p, size);
+        }
+
+        pooled_task get_return_object() noexcept {
+            return pooled_task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        auto final_suspend() noexcept {
+            struct final_awaiter {
+                bool await_ready() noexcept { return false; }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept {
+                    return self.promise().continuation().handle();
+                }
+
+                void await_resume() noexcept {}
+            };
+            return final_awaiter {};
+        }
+
+        void unhandled_exception() noexcept {
+            this->error_ = std::current_exception();
+        }
+    };
+
+    struct awaiter {
+        std::coroutine_handle<promise_type> handle_;
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> parent) noexcept {
+            handle_.promise().set_continuation(parent);
+            return handle_;
+        }
+
+        T await_resume() {
+            return handle_.promise().take();
+        }
+    };
+
+    ~pooled_task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    // move-only
+    pooled_task(pooled_task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    pooled_task& operator=(pooled_task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    pooled_task(const pooled_task&) = delete;
+    pooled_task& operator=(const pooled_task&) = delete;
+
+    awaiter operator co_await() const noexcept {
+        return awaiter { handle_ };
+    }
+
+private:
+    explicit pooled_task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
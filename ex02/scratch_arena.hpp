@@ -0,0 +1,252 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <stdexec/execution.hpp>
+
+/// A bump allocator for transient per-frame buffers, e.g. `std::pmr::vector<int32_t>(n, &arena)`.
+///
+/// Allocation advances a pointer within the current block; deallocation does nothing. `rewind`
+/// (or `reset`) makes everything allocated since a `mark` available again but keeps the blocks, so
+/// once the arena has grown to a frame's (or batch's) peak, scratch memory never touches the heap.
+/// Not thread-safe: each worker uses its own, `scratch_arena::local()`.
+class scratch_arena : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t default_block_bytes = 64 * 1024;
+
+    /// A position to `rewind` to.
+    struct marker {
+        std::size_t block {};
+        std::size_t offset {};
+    };
+
+    /// Rewinds the arena to where it was when the scope was entered.
+    class scope {
+    public:
+        explicit scope(scratch_arena& arena) noexcept : arena_(arena), mark_(arena.mark()) {}
+        ~scope() { arena_.rewind(mark_); }
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+    private:
+        scratch_arena& arena_;
+        marker mark_;
+    };
+
+    explicit scratch_arena(std::size_t block_bytes = default_block_bytes) : block_bytes_(block_bytes) {}
+
+    scratch_arena(const scratch_arena&) = delete;
+    scratch_arena& operator=(const scratch_arena&) = delete;
+
+    /// The calling thread's arena.
+    static scratch_arena& local() {
+        thread_local scratch_arena arena;
+        return arena;
+    }
+
+    marker mark() const noexcept {
+        return { block_, offset_ };
+    }
+
+    /// Releases everything allocated since `m` was taken.
+    void rewind(marker m) noexcept {
+        block_ = m.block;
+        offset_ = m.offset;
+    }
+
+    void reset() noexcept {
+        rewind({});
+    }
+
+    /// Bytes obtained from the heap so far; stays flat in steady state.
+    std::size_t capacity() const noexcept {
+        auto bytes = std::size_t {};
+        for (auto& b : blocks_) bytes += b.size;
+        return bytes;
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        for (;;) {
+            if (block_ < blocks_.size()) {
+                auto& b = blocks_[block_];
+                auto base = reinterpret_cast<std::uintptr_t>(b.data.get());
+                auto p = (base + offset_ + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+                if (p + bytes <= base + b.size) {
+                    offset_ = p + bytes - base;
+                    return reinterpret_cast<void*>(p);
+                }
+                // doesn't fit: move on, the rest of this block stays unused until the next rewind
+                ++block_;
+                offset_ = 0;
+                continue;
+            }
+
+            auto size = std::max(block_bytes_, bytes + alignment);
+            blocks_.push_back({ std::make_unique<std::byte[]>(size), size });
+        }
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    struct block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    std::size_t block_bytes_;
+    std::vector<block> blocks_;
+    std::size_t block_ {};
+    std::size_t offset_ {};
+};
+
+/// Query for the scratch arena of the work being run: `stdexec::read_env(get_scratch_arena)`.
+struct get_scratch_arena_t : stdexec::forwarding_query_t {
+    template <typename Env>
+        requires requires(const Env& env, const get_scratch_arena_t& self) { { env.query(self) } -> std::same_as<scratch_arena&>; }
+    scratch_arena& operator()(const Env& env) const noexcept {
+        return env.query(*this);
+    }
+};
+
+inline constexpr get_scratch_arena_t get_scratch_arena {};
+
+namespace detail {
+
+// the arena handed out by one `with_scratch_arena` operation and where to rewind it to
+struct scratch_arena_lease {
+    scratch_arena* arena {};
+    scratch_arena::marker mark;
+
+    scratch_arena& acquire() noexcept {
+        if (!arena) {
+            arena = &scratch_arena::local();
+            mark = arena->mark();
+        }
+        return *arena;
+    }
+
+    void release() noexcept {
+        if (arena) arena->rewind(mark);
+    }
+};
+
+template <typename Env>
+struct scratch_arena_env {
+    Env outer;
+    scratch_arena_lease* lease;
+
+    scratch_arena& query(get_scratch_arena_t) const noexcept {
+        return lease->acquire();
+    }
+
+    template <typename Query, typename... Args>
+        requires (!std::same_as<Query, get_scratch_arena_t>) && std::invocable<Query, const Env&, Args...>
+    decltype(auto) query(Query q, Args&&... args) const noexcept(std::is_nothrow_invocable_v<Query, const Env&, Args...>) {
+        return q(outer, std::forward<Args>(args)...);
+    }
+};
+
+template <typename Sender, typename Receiver>
+struct scratch_arena_op;
+
+template <typename Sender, typename Receiver>
+struct scratch_arena_receiver {
+    using receiver_concept = stdexec::receiver_t;
+
+    template <typename... Values>
+    void set_value(Values&&... values) noexcept {
+        op->lease.release();
+        stdexec::set_value(std::move(op->receiver), std::forward<Values>(values)...);
+    }
+
+    template <typename Error>
+    void set_error(Error&& error) noexcept {
+        op->lease.release();
+        stdexec::set_error(std::move(op->receiver), std::forward<Error>(error));
+    }
+
+    void set_stopped() noexcept {
+        op->lease.release();
+        stdexec::set_stopped(std::move(op->receiver));
+    }
+
+    scratch_arena_env<stdexec::env_of_t<Receiver>> get_env() const noexcept {
+        return { stdexec::get_env(op->receiver), &op->lease };
+    }
+
+    scratch_arena_op<Sender, Receiver>* op;
+};
+
+template <typename Sender, typename Receiver>
+struct scratch_arena_op {
+    using operation_state_concept = stdexec::operation_state_t;
+
+    scratch_arena_op(Sender&& sndr, Receiver rcvr)
+        : receiver(std::move(rcvr))
+        , inner(stdexec::connect(std::move(sndr), scratch_arena_receiver<Sender, Receiver> { this })) {
+    }
+
+    void start() noexcept {
+        stdexec::start(inner);
+    }
+
+    Receiver receiver;
+    scratch_arena_lease lease;
+    stdexec::connect_result_t<Sender, scratch_arena_receiver<Sender, Receiver>> inner;
+};
+
+template <typename Sender>
+struct scratch_arena_sender {
+    using sender_concept = stdexec::sender_t;
+
+    template <typename Env>
+    auto get_completion_signatures(Env&&) const
+        -> stdexec::completion_signatures_of_t<Sender, scratch_arena_env<std::remove_cvref_t<Env>>> {
+        return {};
+    }
+
+    template <stdexec::receiver Receiver>
+    auto connect(Receiver rcvr) && {
+        return scratch_arena_op<Sender, Receiver>(std::move(sndr), std::move(rcvr));
+    }
+
+    Sender sndr;
+};
+
+} // namespace detail
+
+/// Runs `sndr` with `get_scratch_arena` in its environment: the arena of the worker thread that
+/// first asks for it. Everything allocated from the arena while `sndr` runs is released when it
+/// completes, so wrap each frame for a per-frame arena or a whole batch for a per-batch one.
+/// Wrapped senders may nest. Results must not point into the arena.
+template <stdexec::sender Sender>
+auto with_scratch_arena(Sender&& sndr) {
+    return detail::scratch_arena_sender<std::remove_cvref_t<Sender>> { std::forward<Sender>(sndr) };
+}
+
+/// Like `stdexec::then(fn)`, but `fn` also gets the worker's scratch arena, which is rewound after
+/// `fn` returns: `then_with_scratch([](hw_frame&& frame, scratch_arena& scratch) { ... })`.
+template <typename Fn>
+auto then_with_scratch(Fn fn) {
+    return stdexec::let_value([fn = std::move(fn)](auto&... values) mutable {
+        return with_scratch_arena(
+            stdexec::read_env(get_scratch_arena)
+            | stdexec::then([&](scratch_arena& arena) { return fn(std::move(values)..., arena); }));
+    });
+}
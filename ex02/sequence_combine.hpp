@@ -0,0 +1,367 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "memory_budget.hpp"
+#include "sequence_view.hpp"
+#include "wait_strategy.hpp"
+
+/// Combining several frame sequences into one:
+///
+///     exec::iterate(merge(make_frame_sequence(left), make_frame_sequence(right)))   // either camera
+///     exec::iterate(zip(make_frame_sequence(left), make_frame_sequence(right)))     // stereo pairs
+///
+/// Every upstream is pulled by its own thread into a small single-producer/single-consumer ring,
+/// so decoders run concurrently and complete in any order. Producers and the consumer meet only on
+/// atomics (no lock is shared between streams); waiting uses `std::atomic::wait`, after spinning
+/// if the stage's `wait_strategy` says so. Threads start on the first pull and are joined when the
+/// view is destroyed.
+///
+/// Destroying the view cancels the rings, which stops each thread between items, and then joins
+/// the threads; a thread inside an upstream `next()` is only joined once that call returns. Every
+/// upstream must therefore be finite or unblock on its own: one that can block forever (a silent
+/// socket, an `until` predicate that never fires) hangs the destructor.
+
+namespace detail {
+
+// producers bump the epoch after every push; the consumer sleeps on it when all rings are empty.
+// The wake-up call is made only when the consumer announced it is about to sleep, i.e. after
+// `strategy`'s spinning.
+struct consumer_signal {
+    std::atomic<uint32_t> epoch {};
+    std::atomic<bool> consumer_waiting {};
+    wait_strategy strategy;
+
+    uint32_t current() const noexcept {
+        return epoch.load(std::memory_order_seq_cst);
+    }
+
+    void notify() noexcept {
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (consumer_waiting.load(std::memory_order_seq_cst)) {
+            epoch.notify_one();
+        }
+    }
+
+    // block until the epoch moves past `seen`
+    void wait(uint32_t seen) noexcept {
+        if (strategy.poll([&] { return epoch.load(std::memory_order_acquire) != seen; })) return;
+        consumer_waiting.store(true, std::memory_order_seq_cst);
+        if (epoch.load(std::memory_order_seq_cst) == seen) {
+            epoch.wait(seen, std::memory_order_seq_cst);
+        }
+        consumer_waiting.store(false, std::memory_order_relaxed);
+    }
+};
+
+/// A bounded, lock-free ring from one puller thread to the consumer.
+/// With a `budget` stage, buffered items are reserved against it.
+template <typename Item>
+class spsc_channel {
+public:
+    spsc_channel(std::size_t capacity, consumer_signal* signal, memory_budget::stage* budget = nullptr)
+        : slots_(std::bit_ceil(std::max<std::size_t>(1, capacity))), mask_(slots_.size() - 1), signal_(signal), budget_(budget) {
+    }
+
+    ~spsc_channel() {
+        if (!budget_) return;
+        for (auto& slot : slots_) {
+            if (slot) budget_->release(frame_footprint(*slot));
+        }
+    }
+
+    // producer: blocks while full or over budget; false once the consumer has cancelled
+    bool push(Item&& item) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+
+        // an empty ring always takes one item, or a consumer waiting on this stream could never proceed
+        auto bytes = budget_ ? frame_footprint(item) : 0;
+        if (budget_ && !budget_->reserve(bytes, stop_.get_token(), [&] { return head_.load(std::memory_order_acquire) == tail; })) {
+            return false;
+        }
+
+        for (;;) {
+            // the epoch first: a cancel or pop after this load moves it, so the wait below returns
+            auto epoch = space_epoch_.load(std::memory_order_seq_cst);
+            if (cancelled_.load(std::memory_order_seq_cst)) {
+                if (budget_) budget_->release(bytes);
+                return false;
+            }
+
+            producer_waiting_.store(true, std::memory_order_seq_cst);
+            if (tail - head_.load(std::memory_order_seq_cst) < slots_.size()) {
+                producer_waiting_.store(false, std::memory_order_relaxed);
+                break;
+            }
+            space_epoch_.wait(epoch, std::memory_order_acquire);
+        }
+
+        slots_[tail & mask_].emplace(std::move(item));
+        tail_.store(tail + 1, std::memory_order_release);
+        signal_->notify();
+        return true;
+    }
+
+    // producer: no more items; `error` is rethrown to the consumer after the ring drains
+    void finish(std::exception_ptr error = nullptr) {
+        error_ = std::move(error);
+        finished_.store(true, std::memory_order_release);
+        signal_->notify();
+    }
+
+    // consumer: the oldest item, or nullptr if the ring is empty
+    Item* front() noexcept {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return nullptr;
+        return &*slots_[head & mask_];
+    }
+
+    // consumer
+    Item pop() {
+        auto head = head_.load(std::memory_order_relaxed);
+        auto bytes = budget_ ? frame_footprint(*slots_[head & mask_]) : 0;
+        auto item = std::move(*slots_[head & mask_]);
+        slots_[head & mask_].reset();
+        head_.store(head + 1, std::memory_order_seq_cst);
+        if (producer_waiting_.exchange(false, std::memory_order_seq_cst)) {
+            wake_producer();
+        }
+        if (budget_) budget_->release(bytes); // after the head moved, for a producer checking for an empty ring
+        return item;
+    }
+
+    // consumer: every slot is taken, so the producer is (or soon will be) blocked
+    bool full() const noexcept {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_relaxed) == slots_.size();
+    }
+
+    // consumer: the producer finished and every item was popped
+    bool exhausted() const noexcept {
+        return finished_.load(std::memory_order_acquire)
+            && head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+    }
+
+    // consumer, once exhausted()
+    void rethrow_error() {
+        if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+
+    // consumer: stop the producer at its next push
+    void cancel() noexcept {
+        cancelled_.store(true, std::memory_order_seq_cst);
+        stop_.request_stop();
+        wake_producer();
+    }
+
+private:
+    void wake_producer() noexcept {
+        space_epoch_.fetch_add(1, std::memory_order_seq_cst);
+        space_epoch_.notify_one();
+    }
+
+    std::vector<std::optional<Item>> slots_;
+    std::size_t mask_;
+    consumer_signal* signal_;
+    memory_budget::stage* budget_;
+    std::stop_source stop_;                         // interrupts a push waiting on the budget
+
+    alignas(64) std::atomic<std::size_t> head_ {};  // written by the consumer
+    alignas(64) std::atomic<std::size_t> tail_ {};  // written by the producer
+    alignas(64) std::atomic<bool> producer_waiting_ {};
+    std::atomic<uint32_t> space_epoch_ {};
+    std::atomic<bool> finished_ {};
+    std::atomic<bool> cancelled_ {};
+    std::exception_ptr error_;                      // published by finished_
+};
+
+/// One puller thread and channel per upstream range.
+template <typename... Ranges>
+class stream_group {
+public:
+    static constexpr std::size_t size = sizeof...(Ranges);
+
+    stream_group(std::size_t capacity, memory_budget::stage* budget, wait_strategy wait, Ranges... ranges)
+        : signal_ { .strategy = wait }
+        , ranges_(std::in_place, std::move(ranges)...)
+        , channels_(std::make_unique<spsc_channel<std::ranges::range_value_t<Ranges>>>(capacity, &signal_, budget)...) {
+    }
+
+    // joins every puller, each of which first has to return from a blocking `upstream.next()`
+    ~stream_group() {
+        std::apply([](auto&... channel) { (channel->cancel(), ...); }, channels_);
+        for (auto& thread : threads_) thread.join();
+    }
+
+    stream_group(const stream_group&) = delete;
+    stream_group& operator=(const stream_group&) = delete;
+
+    void start() {
+        if (!ranges_) return;
+        start(std::index_sequence_for<Ranges...>());
+        ranges_.reset();
+    }
+
+    template <std::size_t I>
+    auto& channel() noexcept {
+        return *std::get<I>(channels_);
+    }
+
+    consumer_signal& signal() noexcept {
+        return signal_;
+    }
+
+private:
+    template <std::size_t... I>
+    void start(std::index_sequence<I...>) {
+        (threads_.emplace_back([channel = std::get<I>(channels_).get(),
+                                upstream = upstream_cursor(std::move(std::get<I>(*ranges_)))]() mutable {
+            try {
+                while (auto item = upstream.next()) {
+                    if (!channel->push(std::move(*item))) return;
+                }
+                channel->finish();
+            } catch (...) {
+                channel->finish(std::current_exception());
+            }
+        }), ...);
+    }
+
+    consumer_signal signal_;
+    std::optional<std::tuple<Ranges...>> ranges_;
+    std::tuple<std::unique_ptr<spsc_channel<std::ranges::range_value_t<Ranges>>>...> channels_;
+    std::vector<std::thread> threads_;
+};
+
+template <typename... Ranges>
+using first_value_t = std::ranges::range_value_t<std::tuple_element_t<0, std::tuple<Ranges...>>>;
+
+} // namespace detail
+
+/// An item of a merged sequence and the position of the upstream it came from.
+template <typename Item>
+struct merged_item {
+    std::size_t source {};
+    Item item;
+};
+
+/// Interleaves the items of all `ranges` in arrival order; ready upstreams are served round-robin.
+/// Ends when every upstream has ended. All upstreams must have the same item type.
+///
+/// Every upstream buffers up to `capacity` items; with a `budget` stage they also reserve against
+/// the memory budget, and a puller blocks while the budget is exhausted (but always gets one item
+/// into an empty ring).
+template <std::ranges::input_range... Ranges>
+auto merge_with_capacity(std::size_t capacity, memory_budget::stage* budget, Ranges&&... ranges) {
+    using group_t = detail::stream_group<std::views::all_t<Ranges>...>;
+    using item_t = detail::first_value_t<std::views::all_t<Ranges>...>;
+    static_assert((std::is_same_v<std::ranges::range_value_t<Ranges>, item_t> && ...), "merge: upstreams must have the same item type");
+
+    auto group = std::make_unique<group_t>(capacity, budget, wait_strategy {}, std::views::all(std::forward<Ranges>(ranges))...);
+    auto channels = [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<detail::spsc_channel<item_t>*, group_t::size> { &group->template channel<I>()... };
+    }(std::index_sequence_for<Ranges...>());
+
+    return make_pull_view<merged_item<item_t>>(
+        [group = std::move(group), channels, next = std::size_t {}]() mutable -> std::optional<merged_item<item_t>> {
+            group->start();
+            for (;;) {
+                auto epoch = group->signal().current();
+
+                auto live = false;
+                for (std::size_t n = 0; n < channels.size(); ++n) {
+                    auto source = (next + n) % channels.size();
+                    auto channel = channels[source];
+                    if (channel->front()) {
+                        next = source + 1;
+                        return merged_item<item_t> { source, channel->pop() };
+                    }
+                    if (channel->exhausted()) {
+                        channel->rethrow_error();
+                    } else {
+                        live = true;
+                    }
+                }
+
+                if (!live) return std::nullopt;
+                group->signal().wait(epoch);
+            }
+        });
+}
+
+template <std::ranges::input_range... Ranges>
+auto merge(Ranges&&... ranges) {
+    return merge_with_capacity(16, nullptr, std::forward<Ranges>(ranges)...);
+}
+
+/// Pairs up items with equal `index` across all `ranges` and yields them as a tuple. Items without
+/// a partner in every upstream are dropped (and counted in `*dropped`, if given). Indices must
+/// increase within each upstream. Ends when any upstream ends.
+///
+/// Buffering and `budget` are as for `merge_with_capacity`.
+template <std::ranges::input_range... Ranges>
+auto zip_with_capacity(std::size_t capacity, memory_budget::stage* budget, std::size_t* dropped, Ranges&&... ranges) {
+    using group_t = detail::stream_group<std::views::all_t<Ranges>...>;
+    using tuple_t = std::tuple<std::ranges::range_value_t<Ranges>...>;
+
+    auto group = std::make_unique<group_t>(capacity, budget, wait_strategy {}, std::views::all(std::forward<Ranges>(ranges))...);
+
+    return make_pull_view<tuple_t>(
+        [group = std::move(group), dropped]() mutable -> std::optional<tuple_t> {
+            group->start();
+            return [&]<std::size_t... I>(std::index_sequence<I...>) -> std::optional<tuple_t> {
+                for (;;) {
+                    auto epoch = group->signal().current();
+
+                    // wait until every upstream has a head item
+                    auto ended = false;
+                    auto ready = ([&] {
+                        auto& channel = group->template channel<I>();
+                        if (channel.front()) return true;
+                        if (channel.exhausted()) {
+                            channel.rethrow_error();
+                            ended = true;
+                        }
+                        return false;
+                    }() & ...);
+                    if (ended) return std::nullopt;
+                    if (!ready) {
+                        group->signal().wait(epoch);
+                        continue;
+                    }
+
+                    auto lowest = std::min({ group->template channel<I>().front()->index... });
+                    auto highest = std::max({ group->template channel<I>().front()->index... });
+                    if (lowest == highest) {
+                        return tuple_t { group->template channel<I>().pop()... };
+                    }
+
+                    // heads below the highest index have no partner: drop them
+                    ([&] {
+                        auto& channel = group->template channel<I>();
+                        if (channel.front()->index < highest) {
+                            channel.pop();
+                            if (dropped) ++*dropped;
+                        }
+                    }(), ...);
+                }
+            }(std::index_sequence_for<Ranges...>());
+        });
+}
+
+template <std::ranges::input_range... Ranges>
+auto zip(Ranges&&... ranges) {
+    return zip_with_capacity(16, nullptr, nullptr, std::forward<Ranges>(ranges)...);
+}
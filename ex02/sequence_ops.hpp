@@ -0,0 +1,283 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "memory_budget.hpp"
+#include "sequence_view.hpp"
+
+/// Flow-control operators for frame sequences, applied before `exec::iterate`:
+///
+///     exec::iterate(make_frame_sequence(decoder) | buffer(8) | sample(2) | chunk(4))
+///
+/// Storage is allocated once, when the adaptor is applied; pulling items allocates nothing beyond
+/// what upstream does. `chunk` and `window` yield spans into that storage, which stay valid until
+/// the next item is pulled. `exec::iterate` pulls the next item only after the previous one went
+/// through the pipeline, so a stage may use (and for `chunk`, move from) the span freely.
+
+/// Groups every `n` items into one span; the last chunk may be shorter.
+inline auto chunk(std::size_t n) {
+    n = std::max<std::size_t>(1, n);
+
+    return sequence_adaptor { [n]<typename Range>(Range range) {
+        using item_t = std::ranges::range_value_t<Range>;
+
+        auto storage = std::vector<item_t>();
+        storage.reserve(n);
+
+        return make_pull_view<std::span<item_t>>(
+            [upstream = upstream_cursor<Range>(std::move(range)),
+             storage = std::move(storage),
+             n]() mutable -> std::optional<std::span<item_t>> {
+                storage.clear();
+                while (storage.size() < n) {
+                    auto item = upstream.next();
+                    if (!item) break;
+                    storage.push_back(std::move(*item));
+                }
+                if (storage.empty()) {
+                    return std::nullopt;
+                }
+                return std::span<item_t>(storage);
+            });
+    } };
+}
+
+/// Sliding windows of `n` items, advancing by `step` items. With `step > n` the items in between
+/// are skipped. Only full windows are produced. Items are shared between overlapping windows,
+/// so the span is read-only.
+inline auto window(std::size_t n, std::size_t step) {
+    n = std::max<std::size_t>(1, n);
+    step = std::max<std::size_t>(1, step);
+
+    return sequence_adaptor { [n, step]<typename Range>(Range range) {
+        using item_t = std::ranges::range_value_t<Range>;
+
+        auto storage = std::vector<item_t>();
+        storage.reserve(n);
+
+        return make_pull_view<std::span<const item_t>>(
+            [upstream = upstream_cursor<Range>(std::move(range)),
+             storage = std::move(storage),
+             n, step,
+             started = false]() mutable -> std::optional<std::span<const item_t>> {
+                if (started) {
+                    // slide: drop `step` items, or skip past the gap
+                    auto keep = step < n ? n - step : 0;
+                    std::move(storage.end() - static_cast<std::ptrdiff_t>(keep), storage.end(), storage.begin());
+                    storage.erase(storage.begin() + static_cast<std::ptrdiff_t>(keep), storage.end());
+                    for (auto skip = step > n ? step - n : 0; skip > 0; --skip) {
+                        if (!upstream.next()) return std::nullopt;
+                    }
+                }
+                started = true;
+
+                while (storage.size() < n) {
+                    auto item = upstream.next();
+                    if (!item) return std::nullopt;
+                    storage.push_back(std::move(*item));
+                }
+                return std::span<const item_t>(storage);
+            });
+    } };
+}
+
+/// Keeps the first of every `n` items and drops the rest.
+inline auto sample(std::size_t n) {
+    n = std::max<std::size_t>(1, n);
+
+    return sequence_adaptor { [n]<typename Range>(Range range) {
+        using item_t = std::ranges::range_value_t<Range>;
+
+        return make_pull_view<item_t>(
+            [upstream = upstream_cursor<Range>(std::move(range)),
+             n,
+             started = false]() mutable -> std::optional<item_t> {
+                if (started) {
+                    for (std::size_t skip = 1; skip < n; ++skip) {
+                        if (!upstream.next()) return std::nullopt;
+                    }
+                }
+                started = true;
+                return upstream.next();
+            });
+    } };
+}
+
+/// Passes at most `items_per_second` items per second by delaying items that arrive early.
+/// The delay blocks the pulling thread, like `ondemand_range` waiting on its provider does.
+/// Throws `std::invalid_argument` unless the rate is positive and finite.
+inline auto throttle(double items_per_second) {
+    using clock = std::chrono::steady_clock;
+    if (!(items_per_second > 0) || !std::isfinite(items_per_second)) {
+        throw std::invalid_argument("throttle: items_per_second must be positive and finite");
+    }
+    auto interval = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / items_per_second));
+
+    return sequence_adaptor { [interval]<typename Range>(Range range) {
+        using item_t = std::ranges::range_value_t<Range>;
+
+        return make_pull_view<item_t>(
+            [upstream = upstream_cursor<Range>(std::move(range)),
+             interval,
+             next_slot = std::optional<clock::time_point>()]() mutable -> std::optional<item_t> {
+                auto item = upstream.next();
+                if (!item) {
+                    return std::nullopt;
+                }
+
+                auto now = clock::now();
+                if (next_slot && now < *next_slot) {
+                    std::this_thread::sleep_until(*next_slot);
+                    now = *next_slot;
+                }
+                next_slot = now + interval;
+                return item;
+            });
+    } };
+}
+
+namespace detail {
+
+// bounded ring between buffer()'s producer thread and the consumer
+template <typename Range>
+struct buffer_state {
+    using item_t = std::ranges::range_value_t<Range>;
+
+    buffer_state(Range range, std::size_t capacity, memory_budget::stage* budget)
+        : upstream(std::move(range)), ring(capacity), budget(budget) {
+    }
+
+    // joins the producer, which first has to return from a blocking `upstream.next()`; see `buffer`
+    ~buffer_state() {
+        {
+            auto lock = std::unique_lock(mutex);
+            stopping = true;
+        }
+        stop.request_stop();
+        space_available.notify_one();
+        if (producer.joinable()) producer.join();
+
+        if (budget) {
+            for (auto& slot : ring) {
+                if (slot) budget->release(frame_footprint(*slot));
+            }
+        }
+    }
+
+    void produce() {
+        try {
+            for (;;) {
+                auto item = upstream.next();
+                if (item && budget && !reserve(*item)) return;
+
+                auto lock = std::unique_lock(mutex);
+                space_available.wait(lock, [&] { return stopping || count < ring.size(); });
+                if (stopping) {
+                    if (item && budget) budget->release(frame_footprint(*item));
+                    return;
+                }
+                if (!item) {
+                    done = true;
+                    item_available.notify_one();
+                    return;
+                }
+                ring[(head + count) % ring.size()] = std::move(item);
+                if (count++ == 0) {
+                    item_available.notify_one(); // only an empty ring can have a waiting consumer
+                }
+            }
+        } catch (...) {
+            auto lock = std::unique_lock(mutex);
+            error = std::current_exception();
+            done = true;
+            item_available.notify_one();
+        }
+    }
+
+    // an empty ring always takes one item, so the consumer can make progress
+    bool reserve(const item_t& item) {
+        return budget->reserve(frame_footprint(item), stop.get_token(), [&] {
+            auto lock = std::unique_lock(mutex);
+            return count == 0;
+        });
+    }
+
+    std::optional<item_t> consume() {
+        auto lock = std::unique_lock(mutex);
+        if (!producer.joinable()) {
+            producer = std::thread([this] { produce(); });
+        }
+
+        item_available.wait(lock, [&] { return count > 0 || done; });
+        if (count == 0) {
+            if (error) std::rethrow_exception(std::exchange(error, nullptr));
+            return std::nullopt;
+        }
+
+        auto bytes = budget ? frame_footprint(*ring[head]) : 0;
+        auto item = std::move(ring[head]);
+        ring[head].reset();
+        head = (head + 1) % ring.size();
+        if (count-- == ring.size()) {
+            space_available.notify_one(); // only a full ring can have a waiting producer
+        }
+        lock.unlock();
+
+        if (budget) budget->release(bytes); // not under `mutex`: the budget calls back into reserve()'s check
+        return item;
+    }
+
+    upstream_cursor<Range> upstream;    // producer thread only
+    std::vector<std::optional<item_t>> ring;
+    memory_budget::stage* budget;
+    std::size_t head {};
+    std::size_t count {};
+    bool done {};
+    bool stopping {};
+    std::exception_ptr error;
+
+    std::mutex mutex;
+    std::condition_variable item_available;
+    std::condition_variable space_available;
+    std::stop_source stop;              // interrupts a producer waiting on the budget
+    std::thread producer;
+};
+
+} // namespace detail
+
+/// Decouples producer and consumer: a thread pulls up to `n` items ahead of the consumer, so a
+/// slow stage and the decoder overlap instead of taking turns. The thread starts on the first pull;
+/// upstream errors are rethrown to the consumer once the buffered items are drained.
+/// With a `budget` stage, buffered items also reserve against the memory budget, and the thread
+/// stops pulling while the budget is exhausted.
+///
+/// Destroying the view stops the thread between items and joins it, so it waits for an upstream
+/// `next()` in progress to return. The upstream must therefore be finite or unblock on its own
+/// (a decoder that keeps producing, a socket closed by its owner); an upstream that can block
+/// forever, such as an `until` predicate that never fires, hangs the destructor.
+inline auto buffer(std::size_t n, memory_budget::stage* budget = nullptr) {
+    n = std::max<std::size_t>(1, n);
+
+    return sequence_adaptor { [n, budget]<typename Range>(Range range) {
+        using item_t = std::ranges::range_value_t<Range>;
+
+        return make_pull_view<item_t>(
+            [state = std::make_unique<detail::buffer_state<Range>>(std::move(range), n, budget)]() mutable {
+                return state->consume();
+            });
+    } };
+}
@@ -0,0 +1,128 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "sequence_combine.hpp"
+
+/// What `sync_by_time` does when a stream runs ahead while it waits for a slower one.
+enum class sync_overflow {
+    block,          // stop pulling the fast stream until the slow one catches up (backpressure)
+    drop_oldest,    // keep pulling and evict the fast stream's oldest buffered frame
+};
+
+/// Counters of a `sync_by_time` view; updated on the consuming thread.
+struct time_sync_stats {
+    std::size_t matched {};
+    std::vector<std::size_t> dropped_unmatched;    // per stream: too old to match any other stream's frame
+    std::vector<std::size_t> dropped_overflow;     // per stream: evicted by `sync_overflow::drop_oldest`
+    std::chrono::nanoseconds max_skew {};          // largest capture-time spread within a matched tuple
+    std::chrono::nanoseconds total_skew {};
+
+    std::chrono::nanoseconds mean_skew() const noexcept {
+        return matched ? total_skew / static_cast<std::chrono::nanoseconds::rep>(matched) : std::chrono::nanoseconds {};
+    }
+};
+
+struct time_sync_options {
+    std::chrono::nanoseconds tolerance { std::chrono::milliseconds(5) };
+    std::size_t buffer_frames = 4;                  // per stream
+    sync_overflow overflow = sync_overflow::block;
+    time_sync_stats* stats = nullptr;
+    memory_budget::stage* budget = nullptr;         // buffered frames reserve against it; a full budget blocks like a full
+                                                    // buffer, so leave room for a frame of every stream
+    wait_strategy wait {};                          // how the consumer waits for the next frame
+};
+
+/// Aligns N streams by `capture_time` into tuples whose capture times are all within `tolerance`
+/// of each other, for decoders that run at different rates. Like `zip`, each upstream is pulled
+/// on its own thread into a bounded buffer (`buffer_frames`).
+///
+/// Only the oldest frame of every stream is considered: when they are within tolerance they are
+/// emitted together; otherwise the oldest of them can no longer match (every other stream has moved
+/// past it) and is dropped. Capture times must not decrease within a stream. Ends when any upstream ends.
+///
+///     auto stats = time_sync_stats {};
+///     exec::iterate(sync_by_time({ .tolerance = 2ms, .stats = &stats }, make_frame_sequence(left), make_frame_sequence(right)))
+template <std::ranges::input_range... Ranges>
+auto sync_by_time(time_sync_options opts, Ranges&&... ranges) {
+    using group_t = detail::stream_group<std::views::all_t<Ranges>...>;
+    using tuple_t = std::tuple<std::ranges::range_value_t<Ranges>...>;
+
+    if (opts.stats) {
+        opts.stats->dropped_unmatched.resize(sizeof...(Ranges));
+        opts.stats->dropped_overflow.resize(sizeof...(Ranges));
+    }
+    auto group = std::make_unique<group_t>(opts.buffer_frames, opts.budget, opts.wait, std::views::all(std::forward<Ranges>(ranges))...);
+
+    return make_pull_view<tuple_t>(
+        [group = std::move(group), opts]() mutable -> std::optional<tuple_t> {
+            group->start();
+            return [&]<std::size_t... I>(std::index_sequence<I...>) -> std::optional<tuple_t> {
+                auto stats = opts.stats;
+                for (;;) {
+                    auto epoch = group->signal().current();
+
+                    auto ended = false;
+                    auto ready = ([&] {
+                        auto& channel = group->template channel<I>();
+                        if (channel.front()) return true;
+                        if (channel.exhausted()) {
+                            channel.rethrow_error();
+                            ended = true;
+                        }
+                        return false;
+                    }() & ...);
+                    if (ended) return std::nullopt;
+
+                    if (!ready) {
+                        // a full buffer stalls its decoder; under drop_oldest make room instead
+                        auto evicted = false;
+                        if (opts.overflow == sync_overflow::drop_oldest) {
+                            ([&] {
+                                auto& channel = group->template channel<I>();
+                                if (channel.full()) {
+                                    channel.pop();
+                                    evicted = true;
+                                    if (stats) ++stats->dropped_overflow[I];
+                                }
+                            }(), ...);
+                        }
+                        if (!evicted) {
+                            group->signal().wait(epoch);
+                        }
+                        continue;
+                    }
+
+                    auto oldest = std::min({ group->template channel<I>().front()->capture_time... });
+                    auto newest = std::max({ group->template channel<I>().front()->capture_time... });
+                    auto skew = std::chrono::duration_cast<std::chrono::nanoseconds>(newest - oldest);
+
+                    if (skew <= opts.tolerance) {
+                        if (stats) {
+                            ++stats->matched;
+                            stats->total_skew += skew;
+                            stats->max_skew = std::max(stats->max_skew, skew);
+                        }
+                        return tuple_t { group->template channel<I>().pop()... };
+                    }
+
+                    // the oldest heads are more than `tolerance` behind the newest one: drop them
+                    ([&] {
+                        auto& channel = group->template channel<I>();
+                        if (newest - channel.front()->capture_time > opts.tolerance) {
+                            channel.pop();
+                            if (stats) ++stats->dropped_unmatched[I];
+                        }
+                    }(), ...);
+                }
+            }(std::index_sequence_for<Ranges...>());
+        });
+}
+
+template <std::ranges::input_range... Ranges>
+auto sync_by_time(std::chrono::nanoseconds tolerance, Ranges&&... ranges) {
+    return sync_by_time(time_sync_options { .tolerance = tolerance }, std::forward<Ranges>(ranges)...);
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <utility>
+
+/// Building blocks for sequence adaptors over move-only item streams such as `ondemand_sequence`.
+///
+/// An adaptor is written as a stateful *pull* function: each call returns the next item, or
+/// `std::nullopt` at the end. `pull_view` turns such a function into a move-only input range, so
+/// adaptors chain with `|` in front of `exec::iterate`, the bridge to sequence senders used in ex02:
+///
+///     exec::iterate(make_frame_sequence(decoder) | dedup())
+///
+/// Items are handed out by value (moved), as with `ondemand_range`. A view must not be moved once
+/// iteration has started.
+
+/// A move-only input range whose items come from `Pull`, a callable returning `std::optional<Item>`.
+template <typename Item, typename Pull>
+class pull_view : public std::ranges::view_interface<pull_view<Item, Pull>> {
+public:
+    explicit pull_view(Pull pull) : pull_(std::in_place, std::move(pull)) {}
+    ~pull_view() = default;
+
+    // move-only; assignment is spelled out because closures are not assignable
+    pull_view(pull_view&&) = default;
+    pull_view& operator=(pull_view&& other) {
+        if (this != &other) {
+            pull_.emplace(std::move(*other.pull_));
+        }
+        return *this;
+    }
+    pull_view(const pull_view&) = delete;
+    pull_view& operator=(const pull_view&) = delete;
+
+    class iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = Item;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        explicit iterator(pull_view* parent) : parent_(parent) {
+            ++(*this); // load first item
+        }
+
+        // move-only
+        iterator(iterator&&) = default;
+        iterator& operator=(iterator&&) = default;
+        iterator(const iterator&) = delete;
+        iterator& operator=(const iterator&) = delete;
+
+        iterator& operator++() {
+            current_ = (*parent_->pull_)();
+            return *this;
+        }
+
+        void operator++(int) {
+            ++(*this);
+        }
+
+        Item operator*() const {
+            return std::move(*current_);
+        }
+
+        bool operator==(std::default_sentinel_t) const {
+            return !current_;
+        }
+
+    private:
+        pull_view* parent_ {};
+        mutable std::optional<Item> current_;   // mutable for move-semantics
+    };
+
+    iterator begin() {
+        return iterator(this);
+    }
+
+    std::default_sentinel_t end() const {
+        return std::default_sentinel;
+    }
+
+private:
+    std::optional<Pull> pull_;
+};
+
+template <typename Item, typename Pull>
+pull_view<Item, Pull> make_pull_view(Pull pull) {
+    return pull_view<Item, Pull>(std::move(pull));
+}
+
+/// Pulls items one at a time out of an input range, moving each one out.
+template <std::ranges::input_range Range>
+class upstream_cursor {
+public:
+    using item_type = std::ranges::range_value_t<Range>;
+
+    explicit upstream_cursor(Range range) : range_(std::move(range)) {}
+
+    // move-only; only before the first `next()`
+    upstream_cursor(upstream_cursor&&) = default;
+    upstream_cursor& operator=(upstream_cursor&&) = default;
+    upstream_cursor(const upstream_cursor&) = delete;
+    upstream_cursor& operator=(const upstream_cursor&) = delete;
+
+    std::optional<item_type> next() {
+        if (!it_) {
+            it_.emplace(std::ranges::begin(range_));
+        } else if (!done_) {
+            ++*it_;
+        }
+
+        if (done_ || *it_ == std::ranges::end(range_)) {
+            done_ = true;
+            return std::nullopt;
+        }
+        return std::ranges::iter_move(*it_);
+    }
+
+private:
+    Range range_;
+    std::optional<std::ranges::iterator_t<Range>> it_;
+    bool done_ {};
+};
+
+/// A pipeable adaptor: `range | adaptor` calls `fn(std::views::all(range))`.
+template <typename Fn>
+struct sequence_adaptor {
+    Fn fn;
+
+    template <std::ranges::input_range Range>
+    friend auto operator|(Range&& range, sequence_adaptor self) {
+        return self.fn(std::views::all(std::forward<Range>(range)));
+    }
+};
+
+template <typename Fn>
+sequence_adaptor(Fn) -> sequence_adaptor<Fn>;
@@ -0,0 +1,179 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <queue>
+#include <random>
+#include <vector>
+#include <stdexec/execution.hpp>
+
+/// A single-threaded, virtual-time execution context for reproducible runs.
+///
+/// Its scheduler can stand in for `static_thread_pool`, `single_thread_context` and `run_loop`:
+/// every scheduled operation is queued with a virtual due time and `run()` executes them in order
+/// on the calling thread, advancing the clock to each due time. Nothing ever sleeps.
+///
+/// The `seed` decides the order of operations due at the same instant and, with `latency_jitter`,
+/// perturbs every `schedule_after` delay by up to that fraction. A given seed always replays
+/// the same interleaving.
+class sim_context {
+public:
+    using duration = std::chrono::nanoseconds;
+
+    explicit sim_context(uint64_t seed, double latency_jitter = 0.0)
+        : rng_(seed), jitter_(std::clamp(latency_jitter, 0.0, 1.0)) {
+    }
+
+    // non-copyable, non-movable: operations point back at the context
+    sim_context(const sim_context&) = delete;
+    sim_context& operator=(const sim_context&) = delete;
+
+    struct task_base {
+        void (*execute)(task_base*) noexcept;
+        duration due;
+        uint64_t tiebreak;
+    };
+
+    class scheduler;
+
+    template <class Receiver>
+    struct operation : task_base {
+        using operation_state_concept = stdexec::operation_state_t;
+
+        static void execute_impl(task_base* base) noexcept {
+            auto op = static_cast<operation*>(base);
+            if (stdexec::get_stop_token(stdexec::get_env(op->receiver)).stop_requested()) {
+                stdexec::set_stopped(std::move(op->receiver));
+            } else {
+                stdexec::set_value(std::move(op->receiver));
+            }
+        }
+
+        void start() noexcept {
+            this->execute = &execute_impl;
+            ctx->enqueue(this, delay);
+        }
+
+        Receiver receiver;
+        sim_context* ctx;
+        duration delay;
+    };
+
+    struct env {
+        template <class CPO>
+        scheduler query(stdexec::get_completion_scheduler_t<CPO>) const noexcept;
+
+        sim_context* ctx;
+    };
+
+    struct sender {
+        using sender_concept = stdexec::sender_t;
+
+        using completion_signatures = stdexec::completion_signatures<
+            stdexec::set_value_t(),
+            stdexec::set_stopped_t()>;
+
+        template <stdexec::receiver_of<completion_signatures> Receiver>
+        auto connect(Receiver&& receiver) const {
+            return operation<std::decay_t<Receiver>>
+                {
+                    {},
+                    std::forward<Receiver>(receiver),
+                    ctx,
+                    delay
+                };
+        }
+
+        env get_env() const noexcept {
+            return env { ctx };
+        }
+
+        sim_context* ctx;
+        duration delay;
+    };
+
+    class scheduler {
+    public:
+        explicit scheduler(sim_context* ctx) noexcept : ctx_(ctx) {}
+
+        sender schedule() const noexcept {
+            return sender { ctx_, duration::zero() };
+        }
+
+        sender schedule_after(duration delay) const noexcept {
+            return sender { ctx_, delay };
+        }
+
+        /// Current virtual time.
+        duration now() const noexcept {
+            return ctx_->now();
+        }
+
+        bool operator==(const scheduler&) const noexcept = default;
+
+    private:
+        sim_context* ctx_;
+    };
+
+    scheduler get_scheduler() noexcept {
+        return scheduler(this);
+    }
+
+    duration now() const noexcept {
+        return now_;
+    }
+
+    /// Execute queued operations in virtual-time order until none are left or `finish()` is called.
+    void run() {
+        finished_ = false;
+        while (!finished_ && !queue_.empty()) {
+            auto task = queue_.top();
+            queue_.pop();
+
+            now_ = task->due;
+            ++steps_;
+            task->execute(task);
+        }
+    }
+
+    void finish() noexcept {
+        finished_ = true;
+    }
+
+    /// Number of operations executed so far.
+    std::size_t steps() const noexcept {
+        return steps_;
+    }
+
+private:
+    struct later {
+        bool operator()(const task_base* a, const task_base* b) const noexcept {
+            return a->due != b->due ? a->due > b->due : a->tiebreak > b->tiebreak;
+        }
+    };
+
+    void enqueue(task_base* task, duration delay) {
+        if (jitter_ > 0.0 && delay > duration::zero()) {
+            auto factor = std::uniform_real_distribution<double>(1.0 - jitter_, 1.0 + jitter_)(rng_);
+            delay = duration(static_cast<duration::rep>(static_cast<double>(delay.count()) * factor));
+        }
+
+        task->due = now_ + delay;
+        task->tiebreak = rng_();
+        queue_.push(task);
+    }
+
+    std::priority_queue<task_base*, std::vector<task_base*>, later> queue_;
+    std::mt19937_64 rng_;
+    double jitter_;
+    duration now_ {};
+    std::size_t steps_ {};
+    bool finished_ {};
+};
+
+template <class CPO>
+inline sim_context::scheduler sim_context::env::query(stdexec::get_completion_scheduler_t<CPO>) const noexcept {
+    return ctx->get_scheduler();
+}
@@ -0,0 +1,182 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/// A per-thread, size-class slab allocator for coroutine frames, operation states and other small
+/// per-frame objects.
+///
+/// Blocks are carved from chunks that are never returned to the heap, so once warmed up an allocation
+/// is a free-list pop and a release a push, without locks or atomics on the owning thread.
+///
+/// A block released on another thread (e.g. an operation state allocated by the reader and completed
+/// on the decoder's thread) goes onto its owner's remote list with one CAS, and the owner takes the whole
+/// list back when its local list runs dry. Each chunk records its owner, so blocks always return home
+/// and a producer/consumer pair of threads does not grow memory without bound. The pool of an exiting
+/// thread is kept and adopted by the next new thread.
+class slab_pool {
+public:
+    static constexpr std::size_t granularity = 64;      // also the alignment of every block, pooled or not
+    static constexpr std::size_t max_pooled_size = 4096;
+    static constexpr std::size_t chunk_bytes = std::size_t(64) << 10;
+
+    static void* allocate(std::size_t size) {
+        if (size > max_pooled_size) {
+            // plain operator new only promises __STDCPP_DEFAULT_NEW_ALIGNMENT__
+            return ::operator new(size, std::align_val_t { granularity });
+        }
+
+        auto pool = local();
+        auto cls = size_class(size);
+        auto& head = pool->free_lists_[cls];
+        if (!head) {
+            head = pool->remote_lists_[cls].exchange(nullptr, std::memory_order_acquire);
+            if (!head) {
+                pool->refill(cls);
+            }
+        }
+
+        auto node = head;
+        head = node->next;
+        return node;
+    }
+
+    static void deallocate(void* p, std::size_t size) noexcept {
+        if (size > max_pooled_size) {
+            ::operator delete(p, size, std::align_val_t { granularity });
+            return;
+        }
+
+        auto cls = size_class(size);
+        auto owner = chunk_of(p)->owner;
+        if (owner == local()) {
+            owner->free_lists_[cls] = ::new (p) free_node { owner->free_lists_[cls] };
+            return;
+        }
+
+        auto& remote = owner->remote_lists_[cls];
+        auto node = ::new (p) free_node { remote.load(std::memory_order_relaxed) };
+        while (!remote.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    /// Number of chunks requested from the heap so far, across all threads.
+    static std::size_t chunk_count() noexcept {
+        return chunks_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct free_node {
+        free_node* next;
+    };
+
+    struct alignas(granularity) chunk_header {
+        slab_pool* owner;
+    };
+
+    static constexpr std::size_t class_count = max_pooled_size / granularity;
+
+    static std::size_t size_class(std::size_t size) noexcept {
+        return (size + granularity - 1) / granularity - 1;
+    }
+
+    static chunk_header* chunk_of(void* p) noexcept {
+        return reinterpret_cast<chunk_header*>(reinterpret_cast<std::uintptr_t>(p) & ~(chunk_bytes - 1));
+    }
+
+    void refill(std::size_t cls) {
+        const auto block_size = (cls + 1) * granularity;
+
+        // chunks are intentionally leaked; blocks from them may be in flight on other threads
+        auto chunk = static_cast<std::byte*>(::operator new(chunk_bytes, std::align_val_t { chunk_bytes }));
+        ::new (chunk) chunk_header { this };
+
+        auto& head = free_lists_[cls];
+        for (auto offset = sizeof(chunk_header); offset + block_size <= chunk_bytes; offset += block_size) {
+            head = ::new (chunk + offset) free_node { head };
+        }
+        chunks_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // a thread's pool outlives the thread: its blocks may still be released elsewhere
+    struct thread_handle {
+        slab_pool* pool;
+
+        thread_handle() : pool(adopt()) {}
+
+        ~thread_handle() {
+            auto lock = std::unique_lock(orphans_mutex());
+            orphans().push_back(pool);
+        }
+    };
+
+    static slab_pool* adopt() {
+        {
+            auto lock = std::unique_lock(orphans_mutex());
+            if (!orphans().empty()) {
+                auto pool = orphans().back();
+                orphans().pop_back();
+                return pool;
+            }
+        }
+        return new slab_pool();
+    }
+
+    static std::mutex& orphans_mutex() {
+        static auto* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    static std::vector<slab_pool*>& orphans() {
+        static auto* pools = new std::vector<slab_pool*>();
+        return *pools;
+    }
+
+    static slab_pool* local() noexcept {
+        thread_local thread_handle handle;
+        return handle.pool;
+    }
+
+    std::array<free_node*, class_count> free_lists_ {};
+    std::array<std::atomic<free_node*>, class_count> remote_lists_ {};
+    static inline std::atomic<std::size_t> chunks_ {};
+};
+
+/// A standard allocator over `slab_pool`, e.g. for the `get_allocator` query of a receiver environment.
+/// Objects above `slab_pool::max_pooled_size` or aligned beyond `slab_pool::granularity` use the heap.
+template <typename T>
+struct slab_allocator {
+    using value_type = T;
+
+    slab_allocator() = default;
+
+    template <typename U>
+    slab_allocator(const slab_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if constexpr (alignof(T) > slab_pool::granularity) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t { alignof(T) }));
+        } else {
+            return static_cast<T*>(slab_pool::allocate(n * sizeof(T)));
+        }
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if constexpr (alignof(T) > slab_pool::granularity) {
+            ::operator delete(p, n * sizeof(T), std::align_val_t { alignof(T) });
+        } else {
+            slab_pool::deallocate(p, n * sizeof(T));
+        }
+    }
+
+    template <typename U>
+    bool operator==(const slab_allocator<U>&) const noexcept {
+        return true;
+    }
+};
@@ -0,0 +1,62 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <cstdint>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Tells the CPU the thread is busy-waiting: `pause` on x86, `yield` on ARM. Saves power and
+/// frees the core's resources for a hyperthread sibling.
+inline void cpu_relax() noexcept {
+#if defined(__SSE2__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+/// How a consumer waits for a handoff: spin `spin` times with `cpu_relax()`, then give up the CPU
+/// `yields` times, and only then park in the kernel (`std::atomic::wait`, a futex on Linux).
+///
+/// A wake-up from the kernel costs tens of microseconds; a spinning consumer sees the item within
+/// a few hundred nanoseconds but burns its core meanwhile. The default parks right away, which
+/// is the cheapest in CPU. Spinning only pays when producer and consumer run on different cores
+/// at the same time; on a single CPU the yield phase is what lets the producer run.
+///
+/// Waiting stages take a `wait_strategy`, so that e.g. the main-thread `event_loop` spins while a
+/// background stage parks:
+///
+///     auto main_loop = event_loop(wait_strategy::spin_then_park());
+struct wait_strategy {
+    uint32_t spin = 0;
+    uint32_t yields = 0;
+
+    /// Straight to the kernel.
+    static constexpr wait_strategy park() noexcept {
+        return {};
+    }
+
+    /// About 10-50 us of spinning (depending on the cost of `pause`), then a few yields.
+    static constexpr wait_strategy spin_then_park(uint32_t spin = 2000, uint32_t yields = 16) noexcept {
+        return { spin, yields };
+    }
+
+    /// Spins and yields until `ready()`; false if it still is not after both phases, and the
+    /// caller should park. Callers announce they are parking only after this, so producers skip
+    /// the wake-up system call while the consumer spins.
+    template <typename Ready>
+    bool poll(Ready&& ready) const noexcept(noexcept(ready())) {
+        for (uint32_t i = 0; i < spin; ++i) {
+            if (ready()) return true;
+            cpu_relax();
+        }
+        for (uint32_t i = 0; i < yields; ++i) {
+            if (ready()) return true;
+            std::this_thread::yield();
+        }
+        return ready();
+    }
+};
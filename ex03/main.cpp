@@ -0,0 +1,44 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <iostream>
+#include <exec/static_thread_pool.hpp>
+
+#include "decoder.hpp"
+#include "pooled_task.hpp"
+
+void process_frame(hw_frame&& frame, int32_t& total) {
+    std::cout << "process frame index: " << frame.index << ", data: " << frame.data[0] << std::endl;
+    total += frame.index;
+}
+
+// One coroutine per frame; its frame is recycled through slab_pool.
+pooled_task<void> decode_and_process(hw_decoder* decoder, int32_t& total) {
+    auto frame = co_await async_decode_frame<hw_frame>(decoder);
+    process_frame(std::move(frame), total);
+}
+
+// The coroutine equivalent of ex01's `let_value`/`repeat_effect_until` chain.
+pooled_task<int32_t> decode_loop(hw_decoder* decoder, int limit) {
+    int32_t total = 0;
+    for (int count = limit; count > 0; --count) {
+        co_await decode_and_process(decoder, total);
+    }
+    co_return total;
+}
+
+int main() {
+    auto io_pool = exec::static_thread_pool(2);
+    auto io_sched = io_pool.get_scheduler();
+
+    auto decoder = hw_decoder();
+
+    const int limit = 100;
+    auto [total] = stdexec::sync_wait(
+        stdexec::starts_on(io_sched, decode_loop(&decoder, limit))
+    ).value();
+
+    std::cout << "Total: " << total << std::endl;
+    std::cout << "coroutine frame chunks allocated: " << slab_pool::chunk_count() << std::endl;
+
+    return 0;
+}
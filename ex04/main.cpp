@@ -0,0 +1,84 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <iostream>
+#include <exec/sequence/ignore_all_values.hpp>
+#include <exec/sequence/iterate.hpp>
+#include <exec/sequence/transform_each.hpp>
+#include <exec/single_thread_context.hpp>
+
+#include <sys/wait.h>
+
+#include "shm_frame_ring.hpp"
+
+// Producer process: decode frames straight into the shared ring; the decoder allocates each
+// payload from the slot it is published in.
+int run_decoder_process(shm_frame_ring& ring, int limit) {
+    auto decoder = hw_decoder();
+    decoder.latency = std::chrono::microseconds(100);
+
+    for (int i = 0; i < limit; ++i) {
+        auto slot = shm_slot_resource(ring.acquire());
+        decoder.frame_resource = &slot;
+        auto [frame] = stdexec::sync_wait(async_decode_frame<hw_frame>(&decoder)).value();
+        if (!slot.holds(frame.data.data())) {
+            std::cerr << "frame " << frame.index << " was not decoded into its slot" << std::endl;
+            return 1;
+        }
+        ring.publish(frame, frame.data.size());
+    }
+    ring.close();
+
+    return 0;
+}
+
+void process_frame(shm_frame&& frame, int64_t& total) {
+    std::cout << "frame_reader: [" << frame.index << "]: " << frame.data[0] << std::endl;
+    total += frame.index;
+}
+
+// Consumer process: read frames in place from the shared ring as a sequence.
+int64_t run_analytics_process(shm_frame_ring& ring) {
+    auto read_context = exec::single_thread_context();
+    auto frame_sequence = make_shm_frame_sequence(ring);
+
+    int64_t total = 0;
+    auto frame_reader =
+        read_context.get_scheduler().schedule()
+        | stdexec::let_value([&] {
+            return
+                exec::iterate(std::move(frame_sequence))
+                | exec::transform_each(stdexec::then([&total](auto&& frame) {
+                    process_frame(std::forward<decltype(frame)>(frame), total);
+                }))
+                | exec::ignore_all_values();
+        });
+
+    stdexec::sync_wait(std::move(frame_reader));
+    return total;
+}
+
+int main() {
+    const int limit = 1000;
+
+    // the ring must exist before fork so both processes map the same memfd
+    auto ring = shm_frame_ring::create(8, 1024);
+
+    auto pid = ::fork();
+    if (pid < 0) {
+        std::cerr << "fork failed" << std::endl;
+        return 1;
+    }
+    if (pid == 0) {
+        std::_Exit(run_decoder_process(ring, limit));
+    }
+
+    auto total = run_analytics_process(ring);
+
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+
+    const int64_t expected = int64_t(limit) * (limit - 1) / 2;
+    std::cout << "Total: " << total << " (expected " << expected << ")" << std::endl;
+
+    return (total == expected && WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : 1;
+}
@@ -0,0 +1,379 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "decoder.hpp"
+#include "ondemand_range.hpp"
+
+class shm_frame_ring;
+
+/// A frame that lives in a `shm_frame_ring` slot.
+/// Mirrors `hw_frame` but `data` views the shared mapping instead of owning a copy.
+/// The slot is handed back to the producer when the frame is destroyed.
+class shm_frame : public frame_header {
+public:
+    std::span<const int32_t> data;
+
+    ~shm_frame();
+
+    // move-only
+    shm_frame(shm_frame&& other) noexcept
+        : frame_header(other), data(other.data), ring_(std::exchange(other.ring_, nullptr)), slot_(other.slot_) {}
+    shm_frame& operator=(shm_frame&& other) noexcept;
+    shm_frame(const shm_frame&) = delete;
+    shm_frame& operator=(const shm_frame&) = delete;
+
+private:
+    friend class shm_frame_ring;
+
+    shm_frame(shm_frame_ring* ring, uint32_t slot, const frame_header& header, std::span<const int32_t> d)
+        : frame_header(header), data(d), ring_(ring), slot_(slot) {}
+
+    shm_frame_ring* ring_;
+    uint32_t slot_;
+};
+
+/// A single-producer/single-consumer ring of frames in a memfd mapping, for passing frames
+/// between processes without copying them through a pipe.
+///
+/// The producer writes the payload straight into a slot (`acquire`/`publish`, or `push` to copy an `hw_frame` in),
+/// the consumer reads it in place (`pop`). Both sides park on futex words in the mapping when the ring is
+/// full or empty; a wake-up syscall is only issued when the other side is actually parked.
+///
+/// The memfd is inherited across `fork()`, or can be passed to a sandboxed process over a unix socket
+/// and mapped with `attach`. Consumer calls (`pop`, `wait_readable` and frame destruction) must come from one thread.
+///
+/// The other side may be a sandboxed process, so nothing read from the mapping is trusted: the
+/// geometry is checked against the memfd's size once and kept in local members, and a slot whose
+/// count exceeds the slot size is rejected.
+class shm_frame_ring {
+public:
+    /// Create a ring of `slot_count` slots, each holding up to `max_frame_ints` payload values.
+    static shm_frame_ring create(uint32_t slot_count, uint32_t max_frame_ints) {
+        int fd = ::memfd_create("shm_frame_ring", MFD_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::system_category(), "memfd_create");
+        }
+
+        if (::ftruncate(fd, static_cast<off_t>(mapping_size(slot_count, max_frame_ints))) < 0) {
+            auto err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::system_category(), "ftruncate");
+        }
+
+        return shm_frame_ring(fd, slot_count, max_frame_ints, true);
+    }
+
+    /// Map a ring created by another process. Takes ownership of `fd`, also when it throws.
+    static shm_frame_ring attach(int fd) {
+        auto fail = [fd](auto error) {
+            ::close(fd);
+            throw error;
+        };
+
+        uint32_t geometry[2];
+        auto n = ::pread(fd, geometry, sizeof(geometry), offsetof(shared_header, slot_count));
+        if (n < 0) fail(std::system_error(errno, std::system_category(), "pread"));
+        if (n != sizeof(geometry)) fail(std::runtime_error("shm_frame_ring: mapping too small for a ring"));
+
+        auto [slot_count, slot_ints] = geometry;
+        if (slot_count == 0 || slot_ints == 0) {
+            fail(std::runtime_error("shm_frame_ring: ring has no slots"));
+        }
+
+        // a mapping beyond the end of the memfd would raise SIGBUS on first access
+        struct stat st {};
+        if (::fstat(fd, &st) < 0) fail(std::system_error(errno, std::system_category(), "fstat"));
+        if (static_cast<std::size_t>(st.st_size) < mapping_size(slot_count, slot_ints)) {
+            fail(std::runtime_error("shm_frame_ring: memfd smaller than the ring it describes"));
+        }
+
+        return shm_frame_ring(fd, slot_count, slot_ints, false);
+    }
+
+    ~shm_frame_ring() {
+        ::munmap(header_, bytes_);
+        ::close(fd_);
+    }
+
+    // non-copyable, non-movable: frames point back at the ring
+    shm_frame_ring(shm_frame_ring&&) = delete;
+    shm_frame_ring& operator=(shm_frame_ring&&) = delete;
+    shm_frame_ring(const shm_frame_ring&) = delete;
+    shm_frame_ring& operator=(const shm_frame_ring&) = delete;
+
+    int fd() const noexcept {
+        return fd_;
+    }
+
+    std::size_t max_frame_ints() const noexcept {
+        return slot_ints_;
+    }
+
+    // producer
+
+    /// Wait for a free slot and return its payload area.
+    std::span<int32_t> acquire() {
+        auto head = header_->head.load(std::memory_order_relaxed);
+        park_until(header_->producer_waiting, header_->producer_signal, [&] {
+            return head - header_->tail.load(std::memory_order_acquire) < slot_count_;
+        });
+        return { payload(head % slot_count_), slot_ints_ };
+    }
+
+    /// Make the slot returned by `acquire` visible to the consumer.
+    void publish(const frame_header& frame, std::size_t count) {
+        auto head = header_->head.load(std::memory_order_relaxed);
+        auto slot = slot_at(head % slot_count_);
+        slot->frame = frame_header_record::from(frame);
+        slot->count = static_cast<uint32_t>(count);
+
+        header_->head.store(head + 1, std::memory_order_release);
+        signal(header_->consumer_waiting, header_->consumer_signal);
+    }
+
+    /// Copy `frame` into the next slot; throws `std::length_error` if it does not fit in a slot.
+    void push(const hw_frame& frame) {
+        if (frame.data.size() > max_frame_ints()) {
+            throw std::length_error("shm_frame_ring: frame of " + std::to_string(frame.data.size())
+                                    + " values does not fit a slot of " + std::to_string(max_frame_ints()));
+        }
+        auto payload = acquire();
+        std::memcpy(payload.data(), frame.data.data(), frame.data.size() * sizeof(int32_t));
+        publish(frame, frame.data.size());
+    }
+
+    /// Signal end of stream; the consumer drains what is left.
+    void close() {
+        header_->closed.store(1, std::memory_order_release);
+        signal(header_->consumer_waiting, header_->consumer_signal);
+    }
+
+    // consumer
+
+    /// Wait until a frame is readable or the producer closed the ring.
+    /// Returns false once the ring is closed and drained.
+    bool wait_readable() {
+        park_until(header_->consumer_waiting, header_->consumer_signal, [&] {
+            return readable() || header_->closed.load(std::memory_order_acquire);
+        });
+        return readable();
+    }
+
+    std::optional<shm_frame> pop() {
+        if (!wait_readable()) {
+            return std::nullopt;
+        }
+
+        // read once: the producer may still scribble on the slot after the check
+        auto slot_index = read_ % slot_count_;
+        auto slot = *slot_at(slot_index);
+        if (slot.count > slot_ints_) {
+            throw std::runtime_error("shm_frame_ring: slot claims " + std::to_string(slot.count)
+                                     + " values, more than the slot size " + std::to_string(slot_ints_));
+        }
+
+        ++read_;
+        return shm_frame(this, slot_index, slot.frame.to_header(), { payload(slot_index), slot.count });
+    }
+
+private:
+    struct alignas(64) shared_header {
+        alignas(64) std::atomic<uint32_t> head;           // frames published
+        std::atomic<uint32_t> consumer_signal;            // futex word, bumped on publish/close
+        std::atomic<uint32_t> consumer_waiting;
+        alignas(64) std::atomic<uint32_t> tail;           // frames released
+        std::atomic<uint32_t> producer_signal;            // futex word, bumped on release
+        std::atomic<uint32_t> producer_waiting;
+        alignas(64) std::atomic<uint32_t> closed;
+        uint32_t slot_count;
+        uint32_t slot_ints;
+    };
+
+    struct slot_header {
+        frame_header_record frame;  // capture times compare across processes: CLOCK_MONOTONIC is system-wide
+        uint32_t count;
+        uint32_t reserved;
+    };
+
+    friend class shm_frame;
+
+    shm_frame_ring(int fd, uint32_t slot_count, uint32_t slot_ints, bool initialize)
+        : fd_(fd), bytes_(mapping_size(slot_count, slot_ints)), slot_count_(slot_count), slot_ints_(slot_ints), released_(slot_count) {
+        auto addr = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            auto err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::system_category(), "mmap");
+        }
+
+        header_ = static_cast<shared_header*>(addr);
+        if (initialize) {
+            header_->slot_count = slot_count;
+            header_->slot_ints = slot_ints;
+        }
+    }
+
+    static std::size_t slot_stride(uint32_t slot_ints) noexcept {
+        auto bytes = sizeof(slot_header) + slot_ints * sizeof(int32_t);
+        return (bytes + 63) / 64 * 64;
+    }
+
+    static std::size_t mapping_size(uint32_t slot_count, uint32_t slot_ints) noexcept {
+        return sizeof(shared_header) + std::size_t(slot_count) * slot_stride(slot_ints);
+    }
+
+    slot_header* slot_at(uint32_t slot) const noexcept {
+        auto base = reinterpret_cast<std::byte*>(header_ + 1);
+        return reinterpret_cast<slot_header*>(base + slot * slot_stride(slot_ints_));
+    }
+
+    int32_t* payload(uint32_t slot) const noexcept {
+        return reinterpret_cast<int32_t*>(slot_at(slot) + 1);
+    }
+
+    bool readable() const noexcept {
+        return header_->head.load(std::memory_order_acquire) != read_;
+    }
+
+    void release(uint32_t slot) {
+        // frames may be dropped out of order; the producer only sees the released prefix
+        released_[slot] = true;
+        auto tail = header_->tail.load(std::memory_order_relaxed);
+        auto advanced = false;
+        while (tail != read_ && released_[tail % slot_count_]) {
+            released_[tail++ % slot_count_] = false;
+            advanced = true;
+        }
+
+        if (advanced) {
+            header_->tail.store(tail, std::memory_order_release);
+            signal(header_->producer_waiting, header_->producer_signal);
+        }
+    }
+
+    template <typename Ready>
+    static void park_until(std::atomic<uint32_t>& waiting, std::atomic<uint32_t>& word, Ready ready) {
+        while (!ready()) {
+            waiting.store(1, std::memory_order_seq_cst);
+            auto observed = word.load(std::memory_order_seq_cst);
+            if (!ready()) {
+                ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, observed, nullptr, nullptr, 0);
+            }
+            waiting.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    static void signal(std::atomic<uint32_t>& waiting, std::atomic<uint32_t>& word) {
+        word.fetch_add(1, std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_seq_cst)) {
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+    }
+
+    int fd_;
+    std::size_t bytes_;
+    uint32_t slot_count_;           // geometry as validated; the copies in the mapping are not trusted
+    uint32_t slot_ints_;
+    std::vector<bool> released_;    // consumer-local: slots dropped ahead of `tail`
+    shared_header* header_ {};
+    uint32_t read_ {};              // consumer-local: frames handed out
+};
+
+inline shm_frame::~shm_frame() {
+    if (ring_) {
+        ring_->release(slot_);
+    }
+}
+
+inline shm_frame& shm_frame::operator=(shm_frame&& other) noexcept {
+    if (this != &other) {
+        if (ring_) {
+            ring_->release(slot_);
+        }
+        static_cast<frame_header&>(*this) = other;
+        data = other.data;
+        ring_ = std::exchange(other.ring_, nullptr);
+        slot_ = other.slot_;
+    }
+    return *this;
+}
+
+/// A memory resource over one slot from `shm_frame_ring::acquire`, so that a producer can decode
+/// into the slot directly, e.g. through `hw_decoder::frame_resource`, and `publish` it without a copy:
+///
+///     auto slot = shm_slot_resource(ring.acquire());
+///     decoder.frame_resource = &slot;
+///     ...decode `frame`...
+///     ring.publish(frame, frame.data.size());
+///
+/// It hands out the slot once; a second allocation, or one larger than the slot, throws
+/// `std::bad_alloc`. Deallocation does nothing: the slot belongs to the ring.
+class shm_slot_resource : public std::pmr::memory_resource {
+public:
+    explicit shm_slot_resource(std::span<int32_t> slot) noexcept : slot_(slot) {}
+
+    shm_slot_resource(const shm_slot_resource&) = delete;
+    shm_slot_resource& operator=(const shm_slot_resource&) = delete;
+
+    /// Whether `data` is the slot, i.e. the frame was written in place.
+    bool holds(const int32_t* data) const noexcept {
+        return data == slot_.data();
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (used_ || bytes > slot_.size_bytes() || alignment > alignof(std::max_align_t)) {
+            throw std::bad_alloc();
+        }
+        used_ = true;
+        return slot_.data();
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::span<int32_t> slot_;
+    bool used_ {};
+};
+
+/// Consumer side of a `shm_frame_ring` as an `ondemand_sequence`, ready for `exec::iterate`.
+inline auto make_shm_frame_sequence(shm_frame_ring& ring) {
+    return ondemand_sequence<shm_frame>(
+        // sender to provide items; only called after the until predicate saw a readable frame
+        [&ring] {
+            return stdexec::just()
+                | stdexec::then([&ring] { return std::move(*ring.pop()); });
+        },
+
+        // sender for until predicate: blocks until a frame arrives or the producer closes
+        [&ring] {
+            return stdexec::just()
+                | stdexec::then([&ring] { return !ring.wait_readable(); });
+        }
+    );
+}
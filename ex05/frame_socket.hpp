@@ -0,0 +1,432 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "decoder.hpp"
+#include "frame_codec.hpp"
+#include "memory_budget.hpp"
+#include "ondemand_range.hpp"
+
+/// Wire format: every frame is a 24-byte header followed by its payload: `count` int32 values,
+/// or `encoded_bytes` bytes of `frame_codec` output when the server compresses.
+/// Both are sent in host order; only little-endian hosts are supported. Frame metadata is not sent,
+/// and capture times only compare between processes on one host.
+struct frame_wire_header {
+    frame_header_record header;
+    uint32_t count;
+    uint32_t encoded_bytes; // 0: raw payload
+};
+
+static_assert(sizeof(frame_wire_header) == 24);
+static_assert(std::endian::native == std::endian::little, "frame wire format is little-endian");
+
+/// A socket address given as `unix:/path/to.sock` or `tcp:host:port`.
+struct frame_socket_address {
+    sockaddr_storage storage {};
+    socklen_t length {};
+
+    static frame_socket_address parse(const std::string& address) {
+        auto result = frame_socket_address {};
+
+        if (address.starts_with("unix:")) {
+            auto path = address.substr(5);
+            auto un = reinterpret_cast<sockaddr_un*>(&result.storage);
+            if (path.size() >= sizeof(un->sun_path)) {
+                throw std::invalid_argument("unix socket path too long: " + path);
+            }
+            un->sun_family = AF_UNIX;
+            std::memcpy(un->sun_path, path.c_str(), path.size() + 1);
+            result.length = sizeof(sockaddr_un);
+        } else if (address.starts_with("tcp:")) {
+            auto colon = address.rfind(':');
+            auto host = address.substr(4, colon - 4);
+            auto in = reinterpret_cast<sockaddr_in*>(&result.storage);
+            in->sin_family = AF_INET;
+            in->sin_port = htons(static_cast<uint16_t>(std::stoi(address.substr(colon + 1))));
+            if (::inet_pton(AF_INET, host.c_str(), &in->sin_addr) != 1) {
+                throw std::invalid_argument("invalid tcp host: " + host);
+            }
+            result.length = sizeof(sockaddr_in);
+        } else {
+            throw std::invalid_argument("unsupported frame socket address: " + address);
+        }
+
+        return result;
+    }
+
+    int family() const noexcept {
+        return storage.ss_family;
+    }
+};
+
+inline void throw_socket_error(const char* what) {
+    throw std::system_error(errno, std::system_category(), what);
+}
+
+/// Streams frames to one connected client.
+///
+/// Frames are sent with `writev` straight from their `data` buffers: the server keeps the frames of the
+/// current batch alive and gathers header and payload iovecs, so payloads are never copied in user space.
+/// Small frames are batched into one `writev` (up to `max_batch_frames` / `max_batch_bytes`);
+/// a frame larger than `small_frame_bytes` flushes the batch.
+///
+/// With a `codec`, payloads are compressed into per-slot buffers that are reused from batch to batch,
+/// trading the zero-copy send for less bandwidth.
+class frame_socket_server {
+public:
+    struct options {
+        std::size_t max_batch_frames = 32;
+        std::size_t max_batch_bytes = 64 * 1024;
+        std::size_t small_frame_bytes = 4 * 1024;
+        const frame_codec* codec = nullptr;
+        memory_budget::stage* budget = nullptr;     // frames waiting in a batch reserve against it
+    };
+
+    explicit frame_socket_server(const std::string& address)
+        : frame_socket_server(address, options {}) {
+    }
+
+    frame_socket_server(const std::string& address, options opts)
+        : opts_(opts) {
+        auto addr = frame_socket_address::parse(address);
+        family_ = addr.family();
+        if (family_ == AF_UNIX) {
+            unix_path_ = reinterpret_cast<sockaddr_un*>(&addr.storage)->sun_path;
+            ::unlink(unix_path_.c_str());
+        }
+
+        listen_fd_ = ::socket(addr.family(), SOCK_STREAM, 0);
+        if (listen_fd_ < 0) throw_socket_error("socket");
+
+        int one = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr.storage), addr.length) < 0) throw_socket_error("bind");
+        if (::listen(listen_fd_, 1) < 0) throw_socket_error("listen");
+
+        headers_.reserve(opts_.max_batch_frames);
+        iov_.reserve(opts_.max_batch_frames * 2);
+        pending_.reserve(opts_.max_batch_frames);
+        if (opts_.codec) {
+            encoded_.resize(opts_.max_batch_frames);
+        }
+    }
+
+    ~frame_socket_server() {
+        if (opts_.budget) opts_.budget->release(reserved_bytes_);
+        if (client_fd_ >= 0) ::close(client_fd_);
+        ::close(listen_fd_);
+        if (!unix_path_.empty()) ::unlink(unix_path_.c_str());
+    }
+
+    // non-copyable
+    frame_socket_server(const frame_socket_server&) = delete;
+    frame_socket_server& operator=(const frame_socket_server&) = delete;
+
+    /// The bound address, with the actual port when `tcp:host:0` was requested.
+    std::string address() const {
+        if (!unix_path_.empty()) return "unix:" + unix_path_;
+
+        auto in = sockaddr_in {};
+        auto length = socklen_t(sizeof(in));
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&in), &length);
+        char host[INET_ADDRSTRLEN] {};
+        ::inet_ntop(AF_INET, &in.sin_addr, host, sizeof(host));
+        return std::string("tcp:") + host + ":" + std::to_string(ntohs(in.sin_port));
+    }
+
+    /// Wait for the client to connect.
+    void accept() {
+        client_fd_ = ::accept(listen_fd_, nullptr, nullptr);
+        if (client_fd_ < 0) throw_socket_error("accept");
+
+        int one = 1;
+#ifdef SO_NOSIGPIPE
+        ::setsockopt(client_fd_, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        if (family_ == AF_INET) {
+            // batching is done here; don't let Nagle add latency on top
+            ::setsockopt(client_fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+    }
+
+    void send(hw_frame&& frame) {
+        if (opts_.budget) {
+            // over budget: our own batch is the memory we can give back right away
+            auto footprint = frame_footprint(frame);
+            if (!opts_.budget->try_reserve(footprint)) {
+                flush();
+                opts_.budget->force_reserve(footprint); // the batch is empty now: always take one frame
+            }
+            reserved_bytes_ += footprint;
+        }
+
+        auto bytes = frame.data.size() * sizeof(int32_t);
+        auto encoded_bytes = uint32_t {};
+
+        if (opts_.codec) {
+            auto& buffer = encoded_[pending_.size()];
+            buffer.resize(opts_.codec->max_encoded_size(frame.data.size()));
+            bytes = encoded_bytes = static_cast<uint32_t>(opts_.codec->encode(frame.data, buffer));
+        }
+
+        headers_.push_back({ frame_header_record::from(frame), static_cast<uint32_t>(frame.data.size()), encoded_bytes });
+        pending_.push_back(std::move(frame));
+        batch_bytes_ += sizeof(frame_wire_header) + bytes;
+
+        if (bytes > opts_.small_frame_bytes
+            || pending_.size() >= opts_.max_batch_frames
+            || batch_bytes_ >= opts_.max_batch_bytes) {
+            flush();
+        }
+    }
+
+    /// Write out the current batch.
+    void flush() {
+        if (pending_.empty()) return;
+
+        iov_.clear();
+        for (std::size_t i = 0; i < pending_.size(); ++i) {
+            iov_.push_back({ &headers_[i], sizeof(frame_wire_header) });
+            if (opts_.codec) {
+                iov_.push_back({ encoded_[i].data(), headers_[i].encoded_bytes });
+            } else if (!pending_[i].data.empty()) {
+                iov_.push_back({ pending_[i].data.data(), pending_[i].data.size() * sizeof(int32_t) });
+            }
+        }
+        write_all(iov_.data(), iov_.size());
+
+        ++batches_sent_;
+        headers_.clear();
+        pending_.clear();
+        batch_bytes_ = 0;
+        if (opts_.budget) opts_.budget->release(std::exchange(reserved_bytes_, 0));
+    }
+
+    /// Flush and signal end of stream to the client.
+    void close() {
+        flush();
+        ::shutdown(client_fd_, SHUT_WR);
+    }
+
+    std::size_t batches_sent() const noexcept {
+        return batches_sent_;
+    }
+
+private:
+    void write_all(iovec* iov, std::size_t count) {
+#ifdef MSG_NOSIGNAL
+        constexpr int flags = MSG_NOSIGNAL;
+#else
+        constexpr int flags = 0;
+#endif
+        while (count > 0) {
+            auto msg = msghdr {};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(std::min<std::size_t>(count, IOV_MAX));
+
+            auto written = ::sendmsg(client_fd_, &msg, flags);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw_socket_error("sendmsg");
+            }
+
+            // skip fully written iovecs, then trim a partially written one
+            auto remaining = static_cast<std::size_t>(written);
+            while (count > 0 && remaining >= iov->iov_len) {
+                remaining -= iov->iov_len;
+                ++iov;
+                --count;
+            }
+            if (count > 0) {
+                iov->iov_base = static_cast<std::byte*>(iov->iov_base) + remaining;
+                iov->iov_len -= remaining;
+            }
+        }
+    }
+
+    options opts_;
+    int family_ {};
+    int listen_fd_ { -1 };
+    int client_fd_ { -1 };
+    std::string unix_path_;
+
+    std::vector<frame_wire_header> headers_;
+    std::vector<hw_frame> pending_;
+    std::vector<std::vector<std::byte>> encoded_;
+    std::vector<iovec> iov_;
+    std::size_t batch_bytes_ {};
+    std::size_t reserved_bytes_ {};
+    std::size_t batches_sent_ {};
+};
+
+/// Receives frames sent by `frame_socket_server`.
+/// Small frames are served from a read buffer so a batch costs one `recv`; large payloads are read
+/// straight into the frame's storage.
+class frame_socket_client {
+public:
+    /// `codec` must match the server's when it compresses. Payloads of received frames are
+    /// allocated from `frame_resource`. A header announcing more than `max_frame_ints` values is
+    /// treated as a corrupt stream, so a bad peer cannot make the client allocate without bound.
+    explicit frame_socket_client(const std::string& address,
+                                 const frame_codec* codec = nullptr,
+                                 std::size_t buffer_bytes = 64 * 1024,
+                                 std::pmr::memory_resource* frame_resource = std::pmr::get_default_resource(),
+                                 std::size_t max_frame_ints = 16 * 1024 * 1024)
+        : codec_(codec), frame_resource_(frame_resource), max_frame_ints_(max_frame_ints), buffer_(buffer_bytes) {
+        auto addr = frame_socket_address::parse(address);
+
+        fd_ = ::socket(addr.family(), SOCK_STREAM, 0);
+        if (fd_ < 0) throw_socket_error("socket");
+
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr.storage), addr.length) < 0) {
+            auto err = errno;
+            ::close(fd_);
+            throw std::system_error(err, std::system_category(), "connect");
+        }
+    }
+
+    ~frame_socket_client() {
+        ::close(fd_);
+    }
+
+    // non-copyable
+    frame_socket_client(const frame_socket_client&) = delete;
+    frame_socket_client& operator=(const frame_socket_client&) = delete;
+
+    /// Block until data is available; returns false at end of stream.
+    bool wait_readable() {
+        return begin_ != end_ || fill() > 0;
+    }
+
+    /// The next frame, or nullopt when the server closed the stream between frames. A stream
+    /// that ends inside a frame, header or payload, throws "frame stream truncated".
+    std::optional<hw_frame> receive() {
+        auto header = frame_wire_header {};
+        auto header_bytes = read_some(&header, sizeof(header));
+        if (header_bytes == 0) {
+            return std::nullopt;
+        }
+        if (header_bytes < sizeof(header)) {
+            throw std::runtime_error("frame stream truncated");
+        }
+        if (header.count > max_frame_ints_) {
+            throw std::runtime_error("frame too large");
+        }
+
+        auto data = hw_frame::data_type(header.count, frame_resource_);
+        if (header.encoded_bytes == 0) {
+            if (!read_exact(data.data(), data.size() * sizeof(int32_t))) {
+                throw std::runtime_error("frame stream truncated");
+            }
+        } else {
+            if (!codec_) {
+                throw std::runtime_error("compressed frame stream but no codec");
+            }
+            if (header.encoded_bytes > codec_->max_encoded_size(header.count)) {
+                throw std::runtime_error("compressed frame larger than its codec allows");
+            }
+            encoded_.resize(header.encoded_bytes);
+            if (!read_exact(encoded_.data(), encoded_.size())) {
+                throw std::runtime_error("frame stream truncated");
+            }
+            codec_->decode(encoded_, data);
+        }
+        return hw_frame(header.header.to_header(), std::move(data));
+    }
+
+private:
+    std::size_t fill() {
+        begin_ = end_ = 0;
+        for (;;) {
+            auto n = ::recv(fd_, buffer_.data(), buffer_.size(), 0);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw_socket_error("recv");
+            }
+            end_ = static_cast<std::size_t>(n);
+            return end_;
+        }
+    }
+
+    bool read_exact(void* dst, std::size_t bytes) {
+        return read_some(dst, bytes) == bytes;
+    }
+
+    // reads `bytes` unless the stream ends first; returns the bytes read
+    std::size_t read_some(void* dst, std::size_t bytes) {
+        auto out = static_cast<std::byte*>(dst);
+        auto read = std::size_t {};
+        while (read < bytes) {
+            if (begin_ == end_) {
+                if (bytes - read >= buffer_.size()) {
+                    // large payload: bypass the buffer
+                    auto n = ::recv(fd_, out + read, bytes - read, MSG_WAITALL);
+                    if (n < 0 && errno == EINTR) continue;
+                    if (n < 0) throw_socket_error("recv");
+                    if (n == 0) return read;
+                    read += static_cast<std::size_t>(n);
+                    continue;
+                }
+                if (fill() == 0) return read;
+            }
+
+            auto n = std::min(bytes - read, end_ - begin_);
+            std::memcpy(out + read, buffer_.data() + begin_, n);
+            begin_ += n;
+            read += n;
+        }
+        return read;
+    }
+
+    int fd_ { -1 };
+    const frame_codec* codec_;
+    std::pmr::memory_resource* frame_resource_;
+    std::size_t max_frame_ints_;
+    std::vector<std::byte> encoded_;
+    std::vector<std::byte> buffer_;
+    std::size_t begin_ {};
+    std::size_t end_ {};
+};
+
+/// The remote frame stream as an `ondemand_sequence`, ready for `exec::iterate`.
+inline auto make_socket_frame_sequence(frame_socket_client& client) {
+    return ondemand_sequence<hw_frame>(
+        // sender to provide items
+        [&client] {
+            return stdexec::just()
+                | stdexec::then([&client] {
+                      // the until predicate saw bytes, so the stream cannot end cleanly here
+                      auto frame = client.receive();
+                      if (!frame) throw std::runtime_error("frame stream truncated");
+                      return std::move(*frame);
+                  });
+        },
+
+        // sender for until predicate: blocks until bytes arrive or the server closes
+        [&client] {
+            return stdexec::just()
+                | stdexec::then([&client] { return !client.wait_readable(); });
+        }
+    );
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <iostream>
+#include <exec/sequence/ignore_all_values.hpp>
+#include <exec/sequence/iterate.hpp>
+#include <exec/sequence/transform_each.hpp>
+#include <exec/single_thread_context.hpp>
+
+#include "frame_socket.hpp"
+
+auto make_frame_sequence(hw_decoder& decoder, int limit) {
+    return ondemand_sequence<hw_frame>(
+        // sender to provide items
+        [&decoder]{ return async_decode_frame<hw_frame>(&decoder); },
+
+        // sender for until predicate
+        [&decoder, limit] { return stdexec::just(decoder.index >= limit); }
+    );
+}
+
+void process_frame(hw_frame&& frame, int64_t& total) {
+    std::cout << "frame_reader: [" << frame.index << "]: " << frame.data[0] << std::endl;
+    total += frame.index;
+}
+
+int main(int argc, char** argv) {
+    // ex05 [address] [--compress]
+    // address: e.g. "unix:/tmp/frames.sock" or "tcp:127.0.0.1:9000"; port 0 picks a free port
+    auto address = std::string(argc > 1 ? argv[1] : "tcp:127.0.0.1:0");
+    auto compress = argc > 2 && std::string_view(argv[2]) == "--compress";
+    const int limit = 1000;
+
+    auto codec = delta_zigzag_codec();
+    auto budget = memory_budget(256 * 1024);
+    auto server_options = frame_socket_server::options {};
+    server_options.codec = compress ? &codec : nullptr;
+    server_options.budget = &budget.add_stage("send batch");
+
+    auto server_context = exec::single_thread_context();
+    auto read_context = exec::single_thread_context();
+
+    auto decoder = hw_decoder();
+    decoder.latency = std::chrono::microseconds(100);
+    auto frame_sequence = make_frame_sequence(decoder, limit);
+
+    auto server = frame_socket_server(address, server_options);
+    auto client = frame_socket_client(server.address(), server_options.codec);
+    auto remote_sequence = make_socket_frame_sequence(client);
+
+    auto frame_server =
+        server_context.get_scheduler().schedule()
+        | stdexec::then([&] { server.accept(); })
+        | stdexec::let_value([&] {
+            return
+                exec::iterate(std::move(frame_sequence))
+                | exec::transform_each(stdexec::then([&server](hw_frame&& frame) {
+                    server.send(std::move(frame));
+                }))
+                | exec::ignore_all_values();
+        })
+        | stdexec::then([&] { server.close(); });
+
+    int64_t total = 0;
+    auto frame_reader =
+        read_context.get_scheduler().schedule()
+        | stdexec::let_value([&] {
+            return
+                exec::iterate(std::move(remote_sequence))
+                | exec::transform_each(stdexec::then([&total](hw_frame&& frame) {
+                    process_frame(std::move(frame), total);
+                }))
+                | exec::ignore_all_values();
+        });
+
+    stdexec::sync_wait(stdexec::when_all(std::move(frame_server), std::move(frame_reader)));
+
+    const int64_t expected = int64_t(limit) * (limit - 1) / 2;
+    std::cout << "Total: " << total << " (expected " << expected << "), "
+              << server.batches_sent() << " batches" << std::endl;
+    std::cout << budget;
+
+    return total == expected ? 0 : 1;
+}
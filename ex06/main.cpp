@@ -0,0 +1,180 @@
+// Copyright (c) 2025 Peter Tran. All rights reserved.
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <exec/async_scope.hpp>
+#include <exec/repeat_effect_until.hpp>
+
+#include "decoder.hpp"
+#include "hdr_histogram.hpp"
+#include "sim_context.hpp"
+
+using sim_decoder = basic_hw_decoder<sim_context&>;
+using sim_duration = sim_context::duration;
+
+struct sim_config {
+    int frames = 1000;
+    std::chrono::microseconds decode_latency { 5000 };
+    std::chrono::microseconds process_cost { 4000 };
+    std::chrono::microseconds poll_interval { 100 };
+    double jitter = 0.5;
+    std::chrono::microseconds frame_interval {}; // open loop when set: the decoder captures a frame every interval
+};
+
+/// Virtual-time results of one replay.
+///
+/// Closed loop, the decoder is asked for the next frame when the pipeline is ready for it, and
+/// latency runs from that request: a slow consumer delays the requests, so its delay is never
+/// recorded (coordinated omission). Open loop (`frame_interval`), frames are captured on schedule
+/// whether or not the pipeline keeps up, and latency runs from the intended capture time.
+struct sim_report {
+    int frames {};
+    sim_duration elapsed {};
+    hdr_histogram latency;      // ns: from capture time when open loop, else from decode request
+    hdr_histogram from_request; // ns: from decode request, what a closed-loop measurement reports
+
+    void record(sim_duration processed, sim_duration requested, frame_clock::time_point captured, bool open_loop) {
+        auto since_request = (processed - requested).count();
+        from_request.record(since_request);
+        latency.record(open_loop ? (processed - captured.time_since_epoch()).count() : since_request);
+        ++frames;
+    }
+
+    double throughput() const {
+        return frames / std::chrono::duration<double>(elapsed).count();
+    }
+
+    static double ms(int64_t ns) {
+        return static_cast<double>(ns) / 1e6;
+    }
+};
+
+/// ex01's architecture: a decode loop writes frame indices into a cache and a reader drains it
+/// on the main loop. The blocking cache read becomes a poll, which is free in virtual time.
+sim_report replay_ex01(uint64_t seed, const sim_config& config) {
+    auto sim = sim_context(seed, config.jitter);
+    auto sched = sim.get_scheduler();
+    auto scope = exec::async_scope();
+
+    auto decoder = sim_decoder(std::in_place, sim);
+    decoder.latency = config.decode_latency;
+
+    decoder.frame_interval = config.frame_interval;
+
+    auto report = sim_report {};
+    auto requested_at = std::vector<sim_duration>();
+    auto frame_cache = std::queue<std::pair<int32_t, frame_clock::time_point>>();
+    int decoded = 0;
+
+    auto frame_decode_and_cache =
+        sched.schedule()
+        | stdexec::let_value([&] {
+            requested_at.push_back(sched.now());
+            return async_decode_frame<hw_frame>(&decoder);
+        })
+        | stdexec::then([&](hw_frame&& frame) {
+            frame_cache.push({ frame.index, frame.capture_time });
+            return ++decoded == config.frames;
+        })
+        | exec::repeat_effect_until();
+
+    auto frame_reader =
+        sched.schedule()
+        | stdexec::let_value([&] {
+            return sched.schedule_after(frame_cache.empty() ? sim_duration(config.poll_interval) : config.process_cost)
+                | stdexec::then([&] {
+                    if (!frame_cache.empty()) {
+                        auto [index, captured] = frame_cache.front();
+                        report.record(sched.now(), requested_at[index], captured, config.frame_interval.count() != 0);
+                        frame_cache.pop();
+                    }
+                    return report.frames == config.frames;
+                });
+        })
+        | exec::repeat_effect_until();
+
+    scope.spawn(std::move(frame_decode_and_cache));
+    scope.spawn(std::move(frame_reader));
+    sim.run();
+    stdexec::sync_wait(scope.on_empty());
+
+    report.elapsed = sim.now();
+    return report;
+}
+
+/// ex02's architecture: frames are pulled one at a time and processed before the next is requested.
+sim_report replay_ex02(uint64_t seed, const sim_config& config) {
+    auto sim = sim_context(seed, config.jitter);
+    auto sched = sim.get_scheduler();
+    auto scope = exec::async_scope();
+
+    auto decoder = sim_decoder(std::in_place, sim);
+    decoder.latency = config.decode_latency;
+    decoder.frame_interval = config.frame_interval;
+
+    auto report = sim_report {};
+    auto requested_at = sim_duration {};
+    auto captured = frame_clock::time_point {};
+
+    auto frame_reader =
+        sched.schedule()
+        | stdexec::let_value([&] {
+            requested_at = sched.now();
+            return async_decode_frame<hw_frame>(&decoder);
+        })
+        | stdexec::let_value([&](hw_frame& frame) {
+            captured = frame.capture_time;
+            return sched.schedule_after(config.process_cost);
+        })
+        | stdexec::then([&] {
+            report.record(sched.now(), requested_at, captured, config.frame_interval.count() != 0);
+            return report.frames == config.frames;
+        })
+        | exec::repeat_effect_until();
+
+    scope.spawn(std::move(frame_reader));
+    sim.run();
+    stdexec::sync_wait(scope.on_empty());
+
+    report.elapsed = sim.now();
+    return report;
+}
+
+void print_report(const char* name, uint64_t seed, const sim_report& report, bool open_loop) {
+    auto& latency = report.latency;
+    std::cout << std::left << std::setw(6) << name << " seed " << std::setw(6) << seed << std::right << std::fixed
+              << std::setprecision(2)
+              << " frames " << report.frames
+              << "  virtual " << std::chrono::duration<double, std::milli>(report.elapsed).count() << " ms"
+              << "  throughput " << report.throughput() << " fps"
+              << "  latency p50 " << sim_report::ms(latency.value_at_percentile(50)) << " ms"
+              << " p99 " << sim_report::ms(latency.value_at_percentile(99)) << " ms"
+              << " p99.9 " << sim_report::ms(latency.value_at_percentile(99.9)) << " ms"
+              << " max " << sim_report::ms(latency.max()) << " ms";
+    if (open_loop) {
+        // what measuring from the decode request would have reported
+        std::cout << "  (from request: p99 " << sim_report::ms(report.from_request.value_at_percentile(99))
+                  << " ms max " << sim_report::ms(report.from_request.max()) << " ms)";
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+    // ex06 [first_seed] [seed_count] [frame_interval_us]: open loop when an interval is given
+    uint64_t first_seed = argc > 1 ? std::stoull(argv[1]) : 1;
+    int seed_count = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    auto config = sim_config {};
+    if (argc > 3) config.frame_interval = std::chrono::microseconds(std::stoll(argv[3]));
+    auto open_loop = config.frame_interval.count() != 0;
+
+    for (auto seed = first_seed; seed < first_seed + seed_count; ++seed) {
+        print_report("ex01", seed, replay_ex01(seed, config), open_loop);
+        print_report("ex02", seed, replay_ex02(seed, config), open_loop);
+    }
+
+    return 0;
+}